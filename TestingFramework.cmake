@@ -11,8 +11,47 @@ mirco_framework_test(input_sup2.yaml)
 mirco_framework_test(input_sup5.yaml)
 mirco_framework_test(input_sup6.yaml)
 mirco_framework_test(input_sup7.yaml)
+mirco_framework_test(input_sup7_multilevel.yaml)
+mirco_framework_test(input_sup7_memorybudget.yaml)
+mirco_framework_test(input_sup7_farfield.yaml)
+mirco_framework_test(input_sup7_hmatrix.yaml)
+mirco_framework_test(input_sup7_mixedprecision.yaml)
+mirco_framework_test(input_sup7_spacefillingcurve.yaml)
+mirco_framework_test(input_sup7_kernellookup.yaml)
+mirco_framework_test(input_sup7_contactsetestimate.yaml)
 mirco_framework_test(input_sup9.yaml)
 mirco_framework_test(input_supN6.yaml)
 if(MIRCO_ENABLE_VISUALIZATIONEXPORT)
   mirco_framework_test(input_sup7_exportVis.yaml)
+  mirco_framework_test(input_sup7_exportVisAsync.yaml)
+endif()
+
+# PERFORMANCE TESTS - comparing the wall time and the number of nonlinear solver iterations with
+# the baseline in Input/performance_baseline.yaml. They rerun the framework tests and depend on the
+# machine, so they are only added on request.
+if(MIRCO_ENABLE_PERFORMANCE_TESTS)
+  macro(mirco_performance_test name_of_input_file)
+    set (input_location ${PROJECT_SOURCE_DIR}/Input/${name_of_input_file})
+    set (baseline_location ${PROJECT_SOURCE_DIR}/Input/performance_baseline.yaml)
+    add_test(NAME performance_${name_of_input_file}
+    COMMAND ./mirco ${input_location} --perf-baseline=${baseline_location})
+    set_tests_properties(performance_${name_of_input_file} PROPERTIES LABELS performance RUN_SERIAL TRUE)
+
+  endmacro(mirco_performance_test)
+
+  # List of performance tests
+  mirco_performance_test(input_sup2.yaml)
+  mirco_performance_test(input_sup5.yaml)
+  mirco_performance_test(input_sup6.yaml)
+  mirco_performance_test(input_sup7.yaml)
+  mirco_performance_test(input_sup7_multilevel.yaml)
+  mirco_performance_test(input_sup7_memorybudget.yaml)
+  mirco_performance_test(input_sup7_farfield.yaml)
+  mirco_performance_test(input_sup7_hmatrix.yaml)
+  mirco_performance_test(input_sup7_mixedprecision.yaml)
+  mirco_performance_test(input_sup7_spacefillingcurve.yaml)
+  mirco_performance_test(input_sup7_kernellookup.yaml)
+  mirco_performance_test(input_sup7_contactsetestimate.yaml)
+  mirco_performance_test(input_sup9.yaml)
+  mirco_performance_test(input_supN6.yaml)
 endif()
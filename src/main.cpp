@@ -1,18 +1,94 @@
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string>
 
 #include "mirco_evaluate.h"
 #include "mirco_inputparameters.h"
 #include "mirco_kokkostypes.h"
+#include "mirco_memory.h"
+#include "mirco_timer.h"
 #include "mirco_topologyutilities.h"
 #include "mirco_utils.h"
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+#include "mirco_exportvisualization.h"
+#endif
 
 using namespace MIRCO;
 
+namespace
+{
+  /**
+   * @brief Compare the wall time of the evaluation and the number of iterations of the nonlinear
+   * solver with the entry of the input file in the performance baseline file.
+   *
+   * The iteration counts are independent of the machine and only allowed to exceed the baseline by
+   * the relative tolerance NnlsIterationsTolerance. The wall time is allowed to exceed the baseline
+   * by the factor WallTimeTolerance plus WallTimeMargin [s], since it depends on the machine.
+   *
+   * @return Whether the performance did not regress
+   */
+  bool CheckPerformance(const std::string& baselineFileName, const std::string& inputFileName,
+      const double wallTime, const SolverStatistics& statistics)
+  {
+    // Printed in the format of the baseline file
+    const std::string inputName = std::filesystem::path(inputFileName).filename().string();
+    std::cout << "Performance of " << inputName << ":\n";
+    std::cout << "  NnlsIterations: " << statistics.nnls_iterations << "\n";
+    std::cout << "  WallTime: " << std::setprecision(3) << wallTime << std::endl;
+
+    std::ifstream fin(baselineFileName);
+    if (!fin)
+      throw std::runtime_error("Cannot open performance baseline file: " + baselineFileName);
+
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    std::string inString = ss.str();
+
+    ryml::Tree tree = ryml::parse_in_arena(c4::to_csubstr(inString));
+    ryml::ConstNodeRef root = tree["performance_baseline"];
+    const double NnlsIterationsTolerance = Utils::get_double(root, "NnlsIterationsTolerance");
+    const double WallTimeTolerance = Utils::get_double(root, "WallTimeTolerance");
+    const double WallTimeMargin = Utils::get_double(root, "WallTimeMargin");
+
+    ryml::ConstNodeRef baseline = root[c4::to_csubstr(inputName)];
+    if (baseline.invalid())
+    {
+      std::cerr << "No performance baseline for " << inputName << " in " << baselineFileName
+                << std::endl;
+      return false;
+    }
+    const int ExpectedNnlsIterations = Utils::get_int(baseline, "NnlsIterations");
+    const double ExpectedWallTime = Utils::get_double(baseline, "WallTime");
+
+    bool passedPerformanceChecks = true;
+    if (statistics.nnls_iterations > (1 + NnlsIterationsTolerance) * ExpectedNnlsIterations)
+    {
+      passedPerformanceChecks = false;
+      std::cerr << "The number of nonlinear solver iterations regressed.\n";
+      std::cerr << "\tIterations = " << statistics.nnls_iterations << "\n";
+      std::cerr << "\tBaseline iterations = " << ExpectedNnlsIterations << "\n";
+      std::cerr << "\tRelative tolerance = " << NnlsIterationsTolerance << std::endl;
+    }
+    if (wallTime > WallTimeTolerance * ExpectedWallTime + WallTimeMargin)
+    {
+      passedPerformanceChecks = false;
+      std::cerr << "The wall time regressed.\n";
+      std::cerr << "\tWall time = " << wallTime << "s\n";
+      std::cerr << "\tBaseline wall time = " << ExpectedWallTime << "s\n";
+      std::cerr << "\tTolerance = " << WallTimeTolerance << " * baseline + " << WallTimeMargin
+                << "s" << std::endl;
+    }
+
+    if (passedPerformanceChecks) std::cout << "All performance checks passed." << std::endl;
+    return passedPerformanceChecks;
+  }
+}  // namespace
+
 int main(int argc, char* argv[])
 {
   Kokkos::initialize(argc, argv);
@@ -25,20 +101,65 @@ int main(int argc, char* argv[])
     std::cout << "Default host memory space: " << typeid(MemorySpace_Host_t).name() << "\n";
     std::cout << "\n";
 
-    if (argc != 2) throw std::runtime_error("The code expects (only) an input file as argument");
+    if (argc < 2)
+      throw std::runtime_error(
+          "The code expects an input file and optionally --perf-baseline=<file> and --timings as "
+          "arguments");
     // Read the input file name from the command line
     std::string inputFileName = argv[1];
 
+    // Performance test mode: compare the performance with a baseline file
+    std::optional<std::string> perfBaselineFileName;
+    // Print a hierarchical breakdown of the wall-clock times
+    bool printTimings = false;
+    for (int i = 2; i < argc; ++i)
+    {
+      const std::string option = argv[i];
+      const std::string prefix = "--perf-baseline=";
+      if (option.compare(0, prefix.size(), prefix) == 0)
+        perfBaselineFileName = option.substr(prefix.size());
+      else if (option == "--timings")
+        printTimings = true;
+      else
+        throw std::runtime_error("Unknown argument: " + option);
+    }
+
     const auto start = std::chrono::high_resolution_clock::now();
 
+    // The phases of the main program are always timed, the ones of the solver only on request
+    Timings timings;
+
     InputParameters inputParams(inputFileName);
 
     ViewVector_d meshgrid = CreateMeshgrid(inputParams.N, inputParams.grid_size);
     const double topologyMax = GetMax(inputParams.topology);
+    Kokkos::fence();
+    timings.Add("setup",
+        std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count());
+
+    printTimings = printTimings || inputParams.solver_options.print_timings;
+    if (printTimings) inputParams.solver_options.timings = &timings;
+
+    SolverStatistics statistics;
+    inputParams.solver_options.statistics = &statistics;
+
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+    // The writer thread writes the export while the results are checked, and all files are written
+    // when it is destroyed at the end of the run
+    std::optional<AsyncVisualizationWriter> visualizationWriter;
+    if (inputParams.solver_options.visualization_async && inputParams.export_visualization_path)
+    {
+      visualizationWriter.emplace(2, inputParams.export_visualization_path);
+      inputParams.solver_options.visualization_writer = &visualizationWriter.value();
+    }
+#endif
 
     // Main evaluation agorithm
     double meanPressure, effectiveContactAreaFraction;
-    Evaluate(meanPressure, effectiveContactAreaFraction, inputParams, topologyMax, meshgrid);
+    {
+      ScopedTimer timer(&timings, "evaluate");
+      Evaluate(meanPressure, effectiveContactAreaFraction, inputParams, topologyMax, meshgrid);
+    }
 
     const auto finish = std::chrono::high_resolution_clock::now();
 
@@ -50,6 +171,35 @@ int main(int argc, char* argv[])
         std::chrono::duration_cast<std::chrono::duration<double>>(finish - start).count();
     std::cout << "Elapsed time is: " + std::to_string(elapsedTime) + "s" << std::endl;
 
+    // High-water marks of the memory: the peak resident set size covers the host memory, the
+    // estimate for the largest predicted contact set also covers device memory
+    std::cout << "Peak resident set size is: " << FormatBytes(GetPeakResidentSetSize())
+              << "\nLargest predicted contact set: " << statistics.max_predicted_contacts
+              << " points (estimated solver memory: "
+              << FormatBytes(
+                     EstimateSolverMemory(inputParams.N, statistics.max_predicted_contacts, true,
+                         inputParams.solver_options.mixed_precision,
+                         inputParams.solver_options.kernel_lookup)
+                         .Total())
+              << ")" << std::endl;
+    if (statistics.on_the_fly_iterations > 0)
+      std::cout << "Influence coefficients computed on the fly in "
+                << statistics.on_the_fly_iterations << " of " << statistics.outer_iterations
+                << " iterations" << std::endl;
+    if (statistics.reused_matrix_entries > 0)
+      std::cout << "Influence coefficients reused from previous iterations: "
+                << 100 * statistics.reused_matrix_entries / statistics.matrix_entries << "%"
+                << std::endl;
+    if (statistics.closed_form_iterations > 0)
+      std::cout << "Contact forces updated in closed form in " << statistics.closed_form_iterations
+                << " of " << statistics.outer_iterations << " iterations" << std::endl;
+    if (inputParams.solver_options.contact_set_estimate)
+      std::cout << "Points added to the contact set estimates: "
+                << statistics.estimate_added_contacts << " (in "
+                << statistics.estimate_extensions << " additional solves)" << std::endl;
+
+    if (printTimings) timings.Print(std::cout);
+
     // Test for correct output if the result_description is given in the input file
     {
       std::ifstream fin(inputFileName);
@@ -102,6 +252,13 @@ int main(int argc, char* argv[])
           return EXIT_FAILURE;
       }
     }
+
+    if (perfBaselineFileName)
+    {
+      if (!CheckPerformance(
+              perfBaselineFileName.value(), inputFileName, timings.Get("evaluate"), statistics))
+        return EXIT_FAILURE;
+    }
   }
   Kokkos::finalize();
 }
@@ -2,31 +2,87 @@
 #include <chrono>
 #include <iomanip>
 #include <iostream>
+#include <map>
 #include <string>
+#include <vector>
 
 #include "mirco_contactstatus.h"
+#include "mirco_flatindentor.h"
 #include "mirco_kokkostypes.h"
 #include "mirco_matrixsetup.h"
+#include "mirco_shapefactors.h"
 #include "mirco_topologyutilities.h"
 
 using namespace MIRCO;
 
+namespace
+{
+  // Compute the shape factors for all N from 0 to nominalN with ComputeShapeFactors() and print
+  // them in the same format as the sequential sweep. The results arrive in arbitrary order, but
+  // each one is printed as soon as all smaller N are available. Every result is written to the
+  // shape factor cache immediately and cached results are not recomputed, so an interrupted sweep
+  // can simply be restarted. Returns the smallest N which could not be computed (nominalN + 1 on
+  // success).
+  int ComputeShapeFactorsConcurrently(const int nominalN, const bool PressureGreenFunFlag)
+  {
+    std::map<int, double> results;
+    std::vector<int> pendingNs;
+    for (int n = 1; n <= nominalN; ++n)
+    {
+      if (const auto cached = getCachedShapeFactor(n, PressureGreenFunFlag))
+        results[n] = *cached;
+      else
+        pendingNs.push_back(n);
+    }
+
+    std::cout << std::fixed << std::setprecision(16) << -1;
+    int N = 1;
+    const auto printAvailable = [&]() {
+      for (; results.count(N); ++N) std::cout << "," << std::endl << results[N];
+    };
+    printAvailable();
+
+    try
+    {
+      ComputeShapeFactors(pendingNs, PressureGreenFunFlag,
+          [&](const int n, const double shapeFactor) {
+            cacheShapeFactor(n, PressureGreenFunFlag, shapeFactor);
+            results[n] = shapeFactor;
+            printAvailable();
+          });
+    }
+    catch (const std::exception& e)
+    {
+      std::cerr << "\nThe concurrent computation of the shape factors stopped at N=" << N << " ("
+                << e.what() << "); the remaining ones are computed sequentially" << std::endl;
+    }
+
+    return N;
+  }
+}  // namespace
+
 // flat and args
 int main(int argc, char* argv[])
 {
-  std::string errorOutput = "The code expects 5 arguments. Use --help for details.";
+  std::string errorOutput = "The code expects 5 or 6 arguments. Use --help for details.";
   if (argc == 1) throw std::runtime_error(errorOutput);
   std::string argv1 = std::string(argv[1]);
   if (argv1 == "-help" || argv1 == "-h" || argv1 == "--help" || argv1 == "--h")
   {
     std::cout << "Usage: flatMirco [N] [Delta] [CompositeYoungs] [LateralLength] "
-                 "[PressureGreenFunctionFlag]\n\n"
+                 "[PressureGreenFunctionFlag] [Solver]\n\n"
               << "Note: if [N] is prefixed with 'a' (e.g. a217) all shape factors from 0 to N "
-                 "(inclusive) will be sequentially computed."
+                 "(inclusive) will be sequentially computed.\n"
+              << "Note: [Solver] is optional and either 'dense' (default), which assembles the "
+                 "full influence coefficient matrix and solves it directly, or 'cg', which uses a "
+                 "symmetry-reduced matrix-free conjugate gradient method and is feasible for "
+                 "large N. With 'cg', the shape factors from 0 to N are computed concurrently and "
+                 "stored in the shape factor cache as soon as they are available; cached shape "
+                 "factors are not recomputed."
               << std::endl;
     return 0;
   }
-  if (argc != 6) throw std::runtime_error(errorOutput);
+  if (argc != 6 && argc != 7) throw std::runtime_error(errorOutput);
 
   bool computeAllUpToN = (argv[1][0] == 'a');
   if (computeAllUpToN) argv1 = argv1.substr(1, argv1.length());
@@ -37,6 +93,10 @@ int main(int argc, char* argv[])
   std::string argv5 = std::string(argv[5]);
   bool PressureGreenFunFlag =
       (argv5 == "t" || argv5 == "T" || argv5 == "true" || argv5 == "True" || argv5 == "1");
+  const std::string solver = (argc == 7) ? std::string(argv[6]) : "dense";
+  if (solver != "dense" && solver != "cg")
+    throw std::runtime_error("Unknown solver '" + solver + "'. Use --help for details.");
+  const bool iterativeSolverFlag = (solver == "cg");
 
   Kokkos::initialize(argc, argv);
   {
@@ -45,8 +105,14 @@ int main(int argc, char* argv[])
     if (computeAllUpToN)
       std::cout << "Shape factors (PressureGreenFunFlag="
                 << (PressureGreenFunFlag ? "true" : "false") << "):\n{\n";
-    int N;
-    for (N = (computeAllUpToN ? 0 : nominalN); N <= nominalN; ++N)
+    // If the concurrent sweep fails (e.g. since the simultaneous solves need too much memory), the
+    // remaining shape factors are computed sequentially
+    int N = (computeAllUpToN ? 0 : nominalN);
+    if (computeAllUpToN && iterativeSolverFlag)
+      N = ComputeShapeFactorsConcurrently(nominalN, PressureGreenFunFlag);
+    // Reason why the computation stopped before nominalN
+    std::string stopReason;
+    for (; N <= nominalN; ++N)
     {
       try
       {
@@ -56,33 +122,52 @@ int main(int argc, char* argv[])
           std::cout << std::fixed << std::setprecision(16) << -1;
           continue;
         }
+
+        // The concurrent sweep may have computed larger N before it stopped
+        if (computeAllUpToN && iterativeSolverFlag)
+        {
+          if (const auto cached = getCachedShapeFactor(N, PressureGreenFunFlag))
+          {
+            std::cout << "," << std::endl << std::fixed << std::setprecision(16) << *cached;
+            continue;
+          }
+        }
         const double gridSize = LateralLength / N;
 
-        ViewVector_d meshgrid = CreateMeshgrid(N, gridSize);
-
-        const int N2 = N * N;
-
-        ViewVector_d xv0 = ViewVector_d("xv0", N2);
-        ViewVector_d yv0 = ViewVector_d("yv0", N2);
-        ViewScalarInt_d counter("counter");
-        Kokkos::deep_copy(counter, 0);
-        Kokkos::parallel_for(
-            N2, KOKKOS_LAMBDA(const int a) {
-              const int i = a / N;
-              const int j = a % N;
-              const int aa = Kokkos::atomic_fetch_add(&counter(), 1);
-              xv0(aa) = meshgrid(i);
-              yv0(aa) = meshgrid(j);
-            });
-
-        // For a flat indentor, the following hold: displacement field = const, active set = entire
-        // domain
-        ViewMatrix_d H = SetupMatrix(xv0, yv0, gridSize, CompositeYoungs, N2, PressureGreenFunFlag);
-        ViewVector_d b0p("b0p", N2);
-        Kokkos::deep_copy(b0p, Delta);
-        ViewVectorInt_d ipiv("ipiv", N2);
-        // Solve H p = b0; b0p becomes s
-        KokkosLapack::gesv(H, b0p, ipiv);
+        ViewVector_d b0p;
+        if (iterativeSolverFlag)
+        {
+          b0p = SolveFlatIndentor(N, Delta, CompositeYoungs, LateralLength, PressureGreenFunFlag);
+        }
+        else
+        {
+          ViewVector_d meshgrid = CreateMeshgrid(N, gridSize);
+
+          const int N2 = N * N;
+
+          ViewVector_d xv0 = ViewVector_d("xv0", N2);
+          ViewVector_d yv0 = ViewVector_d("yv0", N2);
+          ViewScalarInt_d counter("counter");
+          Kokkos::deep_copy(counter, 0);
+          Kokkos::parallel_for(
+              N2, KOKKOS_LAMBDA(const int a) {
+                const int i = a / N;
+                const int j = a % N;
+                const int aa = Kokkos::atomic_fetch_add(&counter(), 1);
+                xv0(aa) = meshgrid(i);
+                yv0(aa) = meshgrid(j);
+              });
+
+          // For a flat indentor, the following hold: displacement field = const, active set =
+          // entire domain
+          ViewMatrix_d H =
+              SetupMatrix(xv0, yv0, gridSize, CompositeYoungs, N2, PressureGreenFunFlag);
+          b0p = ViewVector_d("b0p", N2);
+          Kokkos::deep_copy(b0p, Delta);
+          ViewVectorInt_d ipiv("ipiv", N2);
+          // Solve H p = b0; b0p becomes s
+          KokkosLapack::gesv(H, b0p, ipiv);
+        }
 
         double totalForce;
         double contactArea;
@@ -101,6 +186,7 @@ int main(int argc, char* argv[])
         {
           if (N != 0) std::cout << "," << std::endl;
           std::cout << std::fixed << std::setprecision(16) << shapeFactor_alpha;
+          if (iterativeSolverFlag) cacheShapeFactor(N, PressureGreenFunFlag, shapeFactor_alpha);
         }
         else
         {
@@ -114,10 +200,12 @@ int main(int argc, char* argv[])
       }
       catch (const std::bad_alloc&)
       {
+        stopReason = "ran out of memory";
         break;
       }
-      catch (const std::exception&)
+      catch (const std::exception& e)
       {
+        stopReason = e.what();
         break;
       }
     }
@@ -125,7 +213,7 @@ int main(int argc, char* argv[])
     const auto finish = std::chrono::high_resolution_clock::now();
 
     if (computeAllUpToN) std::cout << "\n}\n\nComputed shape factors up to N=" << N - 1 << "\n";
-    if (N - 1 != nominalN) std::cerr << "(ran out of memory)";
+    if (N - 1 != nominalN) std::cerr << "(stopped at N=" << N << ": " << stopReason << ")";
 
     std::cout << "Elapsed time is: " +
                      std::to_string(
@@ -1,44 +1,306 @@
 #include "mirco_contactpredictors.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "mirco_gridindexmap.h"
+#include "mirco_matrixsetup.h"
+#include "mirco_timer.h"
+
+namespace
+{
+  using namespace MIRCO;
+
+  // Positions of the nonzero flags in ascending order
+  ViewVectorInt_d CompactPositions(const std::string& label, const ViewVectorInt_d flags)
+  {
+    const int n = flags.extent(0);
+    int count = 0;
+    Kokkos::parallel_reduce(
+        label + " count", n,
+        KOKKOS_LAMBDA(const int k, int& local_count) {
+          if (flags(k)) ++local_count;
+        },
+        count);
+
+    ViewVectorInt_d positions(label, count);
+    Kokkos::parallel_scan(
+        label, n, KOKKOS_LAMBDA(const int k, int& position, const bool final) {
+          if (flags(k))
+          {
+            if (final) positions(position) = k;
+            ++position;
+          }
+        });
+    return positions;
+  }
+}  // namespace
+
 namespace MIRCO
 {
-  void ContactSetPredictor(ViewVectorInt_d& activeSet0, ViewVector_d& xv0, ViewVector_d& yv0,
-      ViewVector_d& b0, double zmax, double Delta, double w_el, const ViewMatrix_d topology,
-      const ViewVector_d meshgrid)
+  void ContactSetPredictor(ViewVectorGridIndex_d& activeSet0, ViewVector_d& b0, double zmax,
+      double Delta, double w_el, const ViewMatrix_d topology, const bool spaceFillingCurve)
   {
+    const ScopedRegion region("ContactSetPredictor");
     const int N = topology.extent(0);
+    const GridRangePolicy_t gridPoints(0, static_cast<GridIndex_t>(N) * N);
 
     const double deltaContact = Delta + w_el - zmax;
-    int n0 = 0;
+    GridIndex_t predictedPoints = 0;
     Kokkos::parallel_reduce(
-        N * N,
-        KOKKOS_LAMBDA(const int a, int& local_sum) {
+        "ContactSetPredictor(); count", gridPoints,
+        KOKKOS_LAMBDA(const GridIndex_t a, GridIndex_t& local_sum) {
           if (topology(a / N, a % N) >= -deltaContact) local_sum++;
         },
-        n0);
+        predictedPoints);
 
-    activeSet0 = ViewVectorInt_d("activeSet0", n0);
-    xv0 = ViewVector_d("xv0", n0);
-    yv0 = ViewVector_d("yv0", n0);
+    // The nonlinear solver addresses the predicted points with int positions
+    if (predictedPoints > std::numeric_limits<int>::max())
+      throw std::runtime_error("Too many points predicted to be in contact: " +
+                               std::to_string(predictedPoints));
+    const int n0 = predictedPoints;
+
+    activeSet0 = ViewVectorGridIndex_d("activeSet0", n0);
     b0 = ViewVector_d("b0", n0);
 
     ViewScalarInt_d counter("ContactSetPredictor(); counter");
     Kokkos::deep_copy(counter, 0);
     Kokkos::parallel_for(
-        N * N, KOKKOS_LAMBDA(const int a) {
-          const int i = a / N;
-          const int j = a % N;
-          const double topology_a = topology(i, j);
+        "ContactSetPredictor(); fill", gridPoints, KOKKOS_LAMBDA(const GridIndex_t a) {
+          const double topology_a = topology(a / N, a % N);
           if (topology_a >= -deltaContact)
           {
             const int aa = Kokkos::atomic_fetch_add(&counter(), 1);
             activeSet0(aa) = a;
-            xv0(aa) = meshgrid(i);
-            yv0(aa) = meshgrid(j);
             // Note: b0 = \overbar{u} + w_el = Delta + w_el - (zmax - topology_a);
             b0(aa) = topology_a + deltaContact;
           }
         });
+
+    if (spaceFillingCurve)
+    {
+      // Sort the predicted points by their distance along the curve, which is unique
+      const auto keys_h = Kokkos::create_mirror_view_and_copy(
+          MemorySpace_Host_t(), SpaceFillingCurveKeys(activeSet0, N));
+      ViewVectorInt_h order_h("ContactSetPredictor(); order_h", n0);
+      std::iota(order_h.data(), order_h.data() + n0, 0);
+      std::sort(order_h.data(), order_h.data() + n0,
+          [&](const int k, const int l) { return keys_h(k) < keys_h(l); });
+      const auto order =
+          Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(), order_h);
+
+      const ViewVectorGridIndex_d unsortedActiveSet0 = activeSet0;
+      const ViewVector_d unsortedB0 = b0;
+      activeSet0 = ViewVectorGridIndex_d("activeSet0", n0);
+      b0 = ViewVector_d("b0", n0);
+      const ViewVectorGridIndex_d sortedActiveSet0 = activeSet0;
+      const ViewVector_d sortedB0 = b0;
+      Kokkos::parallel_for(
+          "ContactSetPredictor(); sort along curve", n0, KOKKOS_LAMBDA(const int aa) {
+            sortedActiveSet0(aa) = unsortedActiveSet0(order(aa));
+            sortedB0(aa) = unsortedB0(order(aa));
+          });
+    }
+  }
+
+  void ContactSetPredictor(ViewVectorGridIndex_d& activeSet0, ViewVector_d& xv0,
+      ViewVector_d& yv0, ViewVector_d& b0, double zmax, double Delta, double w_el,
+      const ViewMatrix_d topology, const ViewVector_d meshgrid, const bool spaceFillingCurve)
+  {
+    ContactSetPredictor(activeSet0, b0, zmax, Delta, w_el, topology, spaceFillingCurve);
+
+    const ScopedRegion region("ContactSetPredictor");
+    const int N = topology.extent(0);
+    const int n0 = activeSet0.extent(0);
+    xv0 = ViewVector_d("xv0", n0);
+    yv0 = ViewVector_d("yv0", n0);
+    Kokkos::parallel_for(
+        "ContactSetPredictor(); coordinates", n0, KOKKOS_LAMBDA(const int aa) {
+          const GridIndex_t a = activeSet0(aa);
+          xv0(aa) = meshgrid(a / N);
+          yv0(aa) = meshgrid(a % N);
+        });
+  }
+
+  ViewVectorGridIndex_d SpaceFillingCurveKeys(const ViewVectorGridIndex_d points, const int N)
+  {
+    int n = 1;
+    while (n < N) n *= 2;
+
+    const int count = points.extent(0);
+    ViewVectorGridIndex_d keys("SpaceFillingCurveKeys(); keys", count);
+    Kokkos::parallel_for(
+        "SpaceFillingCurveKeys()", count, KOKKOS_LAMBDA(const int k) {
+          int x = points(k) / N;
+          int y = points(k) % N;
+
+          // Distance of (x, y) along the Hilbert curve of the n x n grid, accumulated from the
+          // quadrants of the coarsest to the finest level, in which (x, y) is rotated into the
+          // orientation of the curve of its quadrant
+          GridIndex_t d = 0;
+          for (int s = n / 2; s > 0; s /= 2)
+          {
+            const int rx = (x & s) > 0;
+            const int ry = (y & s) > 0;
+            d += static_cast<GridIndex_t>(s) * s * ((3 * rx) ^ ry);
+            x &= s - 1;
+            y &= s - 1;
+            if (ry == 0)
+            {
+              if (rx == 1)
+              {
+                x = s - 1 - x;
+                y = s - 1 - y;
+              }
+              const int tmp = x;
+              x = y;
+              y = tmp;
+            }
+          }
+          keys(k) = d;
+        });
+    return keys;
+  }
+
+  ViewVectorInt_d EstimateContactSet(
+      const ViewVectorGridIndex_d activeSet0, const ViewVector_d b0, const ViewMatrix_d topology)
+  {
+    const ScopedRegion region("EstimateContactSet");
+    const std::string kokkosLabelPrefix = "EstimateContactSet(); ";
+    const int N = topology.extent(0);
+    const int n0 = activeSet0.extent(0);
+
+    // Position of every grid point in the predicted set, -1 if it is not predicted
+    const GridIndexMap position(activeSet0, kokkosLabelPrefix + "position");
+
+    // One step of steepest ascent: the highest of the neighbours if it is higher than the point
+    // itself. It is predicted as well, since the predicted points are all points above a height.
+    ViewVectorInt_d summit(kokkosLabelPrefix + "summit", n0);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "ascent", n0, KOKKOS_LAMBDA(const int k) {
+          const GridIndex_t a = activeSet0(k);
+          const int i = a / N;
+          const int j = a % N;
+          int iMax = i;
+          int jMax = j;
+          for (int ii = Kokkos::max(i - 1, 0); ii <= Kokkos::min(i + 1, N - 1); ++ii)
+            for (int jj = Kokkos::max(j - 1, 0); jj <= Kokkos::min(j + 1, N - 1); ++jj)
+              if (topology(ii, jj) > topology(iMax, jMax))
+              {
+                iMax = ii;
+                jMax = jj;
+              }
+          summit(k) = position(GridIndex(iMax, jMax, N));
+        });
+
+    // Pointer jumping: every round doubles the number of steps along the path of steepest ascent,
+    // until all paths end at their summit
+    ViewVectorInt_d next(kokkosLabelPrefix + "next", n0);
+    int changed = n0;
+    while (changed > 0)
+    {
+      Kokkos::parallel_reduce(
+          kokkosLabelPrefix + "pointer jumping", n0,
+          KOKKOS_LAMBDA(const int k, int& local_changed) {
+            next(k) = summit(summit(k));
+            if (next(k) != summit(k)) ++local_changed;
+          },
+          changed);
+      std::swap(summit, next);
+    }
+
+    // Hertz: the points with at least half the interference of their summit are in contact
+    ViewVectorInt_d inContact(kokkosLabelPrefix + "inContact", n0);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "inContact", n0,
+        KOKKOS_LAMBDA(const int k) { inContact(k) = b0(k) >= 0.5 * b0(summit(k)); });
+    const ViewVectorInt_d subset = CompactPositions(kokkosLabelPrefix + "subset", inContact);
+    return subset;
+  }
+
+  void RestrictContactSet(ViewVectorGridIndex_d& activeSet, ViewVector_d& xv, ViewVector_d& yv,
+      ViewVector_d& b, const ViewVectorInt_d subset, const ViewVectorGridIndex_d activeSet0,
+      const ViewVector_d xv0, const ViewVector_d yv0, const ViewVector_d b0)
+  {
+    const int n = subset.extent(0);
+    const bool coordinates = xv0.extent(0) > 0;
+    activeSet = ViewVectorGridIndex_d("activeSet", n);
+    b = ViewVector_d("b", n);
+    xv = ViewVector_d("xv", coordinates ? n : 0);
+    yv = ViewVector_d("yv", coordinates ? n : 0);
+    Kokkos::parallel_for(
+        "RestrictContactSet()", n, KOKKOS_LAMBDA(const int s) {
+          const int k = subset(s);
+          activeSet(s) = activeSet0(k);
+          b(s) = b0(k);
+          if (coordinates)
+          {
+            xv(s) = xv0(k);
+            yv(s) = yv0(k);
+          }
+        });
+  }
+
+  template <typename MatrixType>
+  int ExtendContactSetEstimate(ViewVectorInt_d& subset, ViewVector_d& p, const MatrixType matrix,
+      const ViewVector_d b0, double nnlstol)
+  {
+    const ScopedRegion region("ExtendContactSetEstimate");
+    const std::string kokkosLabelPrefix = "ExtendContactSetEstimate(); ";
+    const int n0 = b0.extent(0);
+    const ViewVectorInt_d estimate = subset;
+    const ViewVector_d pEstimate = p;
+    const int n = estimate.extent(0);
+
+    ViewVectorInt_d flags(kokkosLabelPrefix + "flags", n0);
+    ViewVector_d guess(kokkosLabelPrefix + "guess", n0);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "flags", n, KOKKOS_LAMBDA(const int s) {
+          flags(estimate(s)) = 1;
+          guess(estimate(s)) = pEstimate(s);
+        });
+
+    // Every point only reads and sets its own flag. An added point starts with the contact force
+    // which closes its gap on its own, such that all added points enter the active set of the next
+    // solve at once.
+    int added = 0;
+    Kokkos::parallel_reduce(
+        kokkosLabelPrefix + "w", n0,
+        KOKKOS_LAMBDA(const int i, int& local_added) {
+          if (flags(i)) return;
+          double w = -b0(i);
+          for (int s = 0; s < n; ++s)
+            if (pEstimate(s) > 0.0) w += matrix(i, estimate(s)) * pEstimate(s);
+          if (w < -nnlstol)
+          {
+            flags(i) = 1;
+            guess(i) = -w / matrix(i, i);
+            ++local_added;
+          }
+        },
+        added);
+
+    if (added > 0)
+    {
+      subset = CompactPositions(kokkosLabelPrefix + "subset", flags);
+      const ViewVectorInt_d extended = subset;
+      p = ViewVector_d(kokkosLabelPrefix + "p", extended.extent(0));
+      const ViewVector_d pExtended = p;
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "p", extended.extent(0),
+          KOKKOS_LAMBDA(const int s) { pExtended(s) = guess(extended(s)); });
+    }
+    return added;
   }
 
+  template int ExtendContactSetEstimate(ViewVectorInt_d&, ViewVector_d&,
+      const OnTheFlyMatrix<PressureGreenFunction>, const ViewVector_d, double);
+  template int ExtendContactSetEstimate(ViewVectorInt_d&, ViewVector_d&,
+      const OnTheFlyMatrix<PointForceGreenFunction>, const ViewVector_d, double);
+  template int ExtendContactSetEstimate(ViewVectorInt_d&, ViewVector_d&,
+      const InfluenceKernelMatrix, const ViewVector_d, double);
 }  // namespace MIRCO
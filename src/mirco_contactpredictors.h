@@ -21,10 +21,107 @@ namespace MIRCO
    * @param[in] w_el Elastic correction
    * @param[in] topology Topology matrix containing heights
    * @param[in] meshgrid Meshgrid (coordinates in one direction)
+   * @param[in] spaceFillingCurve Whether the predicted points are stored along a Hilbert curve
+   * (see SpaceFillingCurveKeys()). Otherwise, their order is unspecified.
    */
-  void ContactSetPredictor(ViewVectorInt_d& activeSet0, ViewVector_d& xv0, ViewVector_d& yv0,
-      ViewVector_d& b0, double zmax, double Delta, double w_el, const ViewMatrix_d topology,
-      const ViewVector_d meshgrid);
+  void ContactSetPredictor(ViewVectorGridIndex_d& activeSet0, ViewVector_d& xv0,
+      ViewVector_d& yv0, ViewVector_d& b0, double zmax, double Delta, double w_el,
+      const ViewMatrix_d topology, const ViewVector_d meshgrid,
+      const bool spaceFillingCurve = false);
+
+  /**
+   * @brief Predict the points of contact like ContactSetPredictor() above, but only store their
+   * grid indices, i.e. the point activeSet0(k) has the grid indices (activeSet0(k) / N,
+   * activeSet0(k) % N), from which its coordinates and offsets to other points follow
+   *
+   * @param[out] activeSet0 Points predicted to be in contact in the current iteration
+   * @param[out] b0 Indentation value of the half space at the predicted points of contact
+   * @param[in] zmax Maximum height of the topology
+   * @param[in] Delta Far-field displacement (Gap)
+   * @param[in] w_el Elastic correction
+   * @param[in] topology Topology matrix containing heights
+   * @param[in] spaceFillingCurve Whether the predicted points are stored along a Hilbert curve
+   */
+  void ContactSetPredictor(ViewVectorGridIndex_d& activeSet0, ViewVector_d& b0, double zmax,
+      double Delta, double w_el, const ViewMatrix_d topology, const bool spaceFillingCurve = false);
+
+  /**
+   * @brief Distances of points of an N x N grid along a Hilbert curve, such that points which are
+   * close along the curve are also close in space. The curve fills the smallest grid with a power
+   * of two points in each direction, so the distances of the points of the actual grid are unique
+   * but not contiguous.
+   *
+   * Sorted by these distances, the predicted points of contact form spatial clusters in the
+   * influence coefficient matrix, which improves the cache reuse of its assembly and of the gathers
+   * of the nonlinear solver. Only the distances of the given points are computed, so no array of
+   * all N^2 grid points is needed.
+   *
+   * @param[in] points Grid indices of the points
+   * @param[in] N Element count along one direction
+   *
+   * @return keys(k) is the distance of points(k) along the curve
+   */
+  ViewVectorGridIndex_d SpaceFillingCurveKeys(const ViewVectorGridIndex_d points, const int N);
+
+  /**
+   * @brief Estimate which of the points predicted to be in contact are in contact after the
+   * elastic deformation, in the spirit of the Greenwood-Williamson model: every predicted point
+   * belongs to the asperity whose summit (local maximum of the topology) is reached by steepest
+   * ascent from it. For a paraboloidal asperity with the interference d at its summit, the contact
+   * radius of the Hertz solution is 1/sqrt(2) times the radius of the predicted (interpenetrating)
+   * region, i.e. exactly its points with an interference of at least d / 2 are in contact, which
+   * is the estimate.
+   *
+   * The estimate may miss points in contact; see ExtendContactSetEstimate() for the fallback.
+   *
+   * @param[in] activeSet0 Points predicted to be in contact (see ContactSetPredictor())
+   * @param[in] b0 Indentation value of the half space at the predicted points of contact
+   * @param[in] topology Topology matrix containing heights
+   *
+   * @return Positions in activeSet0 of the points estimated to be in contact, in ascending order
+   */
+  ViewVectorInt_d EstimateContactSet(
+      const ViewVectorGridIndex_d activeSet0, const ViewVector_d b0, const ViewMatrix_d topology);
+
+  /**
+   * @brief Restrict the points predicted to be in contact to a subset
+   *
+   * @param[out] activeSet Points of the subset
+   * @param[out] xv x-coordinates of the points of the subset (empty if xv0 is empty)
+   * @param[out] yv y-coordinates of the points of the subset (empty if yv0 is empty)
+   * @param[out] b Indentation value of the half space at the points of the subset
+   * @param[in] subset Positions of the points of the subset in activeSet0
+   * @param[in] activeSet0 Points predicted to be in contact
+   * @param[in] xv0 x-coordinates of the predicted points, may be empty
+   * @param[in] yv0 y-coordinates of the predicted points, may be empty
+   * @param[in] b0 Indentation value of the half space at the predicted points
+   */
+  void RestrictContactSet(ViewVectorGridIndex_d& activeSet, ViewVector_d& xv, ViewVector_d& yv,
+      ViewVector_d& b, const ViewVectorInt_d subset, const ViewVectorGridIndex_d activeSet0,
+      const ViewVector_d xv0, const ViewVector_d yv0, const ViewVector_d b0);
+
+  /**
+   * @brief Fallback of an estimate of the contact set (see EstimateContactSet()): add the
+   * predicted points outside of it which penetrate the half space under the contact forces solved
+   * for the estimate, i.e. whose gap w = H p - b0 is below -nnlstol. If none is added, the
+   * solution for the estimate is the solution for all predicted points. Otherwise, the contact
+   * forces become the initial guess for the extended estimate, in which every added point has the
+   * contact force that closes its gap on its own, so that the next solve of the nonlinear solver
+   * adds them all to its active set at once (see nonlinearSolve()).
+   *
+   * @tparam MatrixType OnTheFlyMatrix or InfluenceKernelMatrix of the predicted points
+   * @param[in,out] subset Positions of the points of the estimate in the predicted set
+   * @param[in,out] p Contact forces at the points of the estimate, initial guess for the points
+   * of the extended estimate
+   * @param[in] matrix Influence coefficient matrix of the predicted points
+   * @param[in] b0 Indentation value of the half space at the predicted points
+   * @param[in] nnlstol Tolerance of the nonlinear solver
+   *
+   * @return Number of added points
+   */
+  template <typename MatrixType>
+  int ExtendContactSetEstimate(ViewVectorInt_d& subset, ViewVector_d& p, const MatrixType matrix,
+      const ViewVector_d b0, double nnlstol = 1e-8);
 }  // namespace MIRCO
 
 #endif  // SRC_CONTACTPREDICTORS_H_
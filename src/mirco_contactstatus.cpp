@@ -2,27 +2,44 @@
 
 #include <cmath>
 
+#include "mirco_greenfunctions.h"
+
 namespace MIRCO
 {
+  template <typename GreenFunction>
   void ComputeContactForceAndArea(double& totalForce, double& contactArea, const ViewVector_d pf,
-      const double GridSize, const double LateralLength, const bool PressureGreenFunFlag)
+      const double GridSize, const double LateralLength)
   {
     totalForce = 0;
 
     const int activeSetSize = pf.extent(0);
     const double GridSize2 = GridSize * GridSize;
 
-    if (PressureGreenFunFlag)
+    if constexpr (GreenFunction::pressure)
       Kokkos::parallel_reduce(
-          activeSetSize,
+          "ComputeContactForceAndArea(); totalForce", activeSetSize,
           KOKKOS_LAMBDA(const int i, double& local_sum) { local_sum += pf(i) * GridSize2; },
           totalForce);
     else
       Kokkos::parallel_reduce(
-          activeSetSize, KOKKOS_LAMBDA(const int i, double& local_sum) { local_sum += pf(i); },
-          totalForce);
+          "ComputeContactForceAndArea(); totalForce", activeSetSize,
+          KOKKOS_LAMBDA(const int i, double& local_sum) { local_sum += pf(i); }, totalForce);
 
     contactArea = activeSetSize * GridSize2;
   }
 
+  void ComputeContactForceAndArea(double& totalForce, double& contactArea, const ViewVector_d pf,
+      const double GridSize, const double LateralLength, const bool PressureGreenFunFlag)
+  {
+    DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      ComputeContactForceAndArea<GreenFunction>(
+          totalForce, contactArea, pf, GridSize, LateralLength);
+    });
+  }
+
+  template void ComputeContactForceAndArea<PressureGreenFunction>(
+      double&, double&, const ViewVector_d, const double, const double);
+  template void ComputeContactForceAndArea<PointForceGreenFunction>(
+      double&, double&, const ViewVector_d, const double, const double);
 }  // namespace MIRCO
@@ -9,11 +9,22 @@ namespace MIRCO
    * @brief Calculate the contact force and contact area for the
    * current iteration.
    *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction; determines whether pf
+   * are pressures or forces
    * @param[out] totalForce Total force
    * @param[out] contactArea Contact area
    * @param[in] pf Contact force vector.
    * @param[in] GridSize Grid size (length of each cell)
    * @param[in] LateralLength Lateral side of the surface [micrometers]
+   */
+  template <typename GreenFunction>
+  void ComputeContactForceAndArea(double& totalForce, double& contactArea, const ViewVector_d pf,
+      const double GridSize, const double LateralLength);
+
+  /**
+   * @brief Calculate the contact force and contact area with the Green function selected at
+   * runtime, see ComputeContactForceAndArea() above
+   *
    * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead of
    * point force
    */
@@ -2,95 +2,323 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <ctime>
 #include <iostream>
+#include <optional>
+#include <string>
 
 #include "mirco_contactpredictors.h"
 #include "mirco_contactstatus.h"
+#include "mirco_greenfunctions.h"
+#include "mirco_hmatrix.h"
+#include "mirco_influenceoperator.h"
 #include "mirco_matrixsetup.h"
+#include "mirco_memory.h"
+#include "mirco_multilevel.h"
 #include "mirco_nonlinearsolver.h"
+#include "mirco_timer.h"
+#include "mirco_topologyutilities.h"
 #include "mirco_warmstart.h"
 
 #if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
 #include "mirco_exportvisualization.h"
-#include "mirco_topologyutilities.h"
 #endif
 
-namespace MIRCO
+namespace
 {
-  void Evaluate(double& pressure, double& effectiveContactAreaFraction, const double Delta,
+  using namespace MIRCO;
+
+  /**
+   * @brief Run the iterations of the elastic compliance correction on one grid
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   * @param[out] totalForceVector Total force of every iteration
+   * @param[out] contactAreaVector Contact area of every iteration
+   * @param[in,out] w_el Elastic correction; the value passed in is used in the first iteration
+   * @param[in,out] activeSetf Points in contact at the end of the last iteration; if not empty on
+   * input, it is used together with pf as the initial guess of the first iteration
+   * @param[in,out] pf Contact forces at the points in activeSetf
+   * @param[in] options Optional algorithmic settings; the times and statistics of the iterations
+   * are added to options.timings and options.statistics
+   *
+   * @return Relative difference in total force between the last two iterations
+   */
+  template <typename GreenFunction>
+  double SolveOnGrid(std::vector<double>& totalForceVector, std::vector<double>& contactAreaVector,
+      double& w_el, ViewVectorGridIndex_d& activeSetf, ViewVector_d& pf, const double Delta,
       const double LateralLength, const double GridSize, const double Tolerance,
       const int MaxIteration, const double CompositeYoungs, const bool WarmStartingFlag,
       const double ElasticComplianceCorrection, const ViewMatrix_d topology, const double zmax,
-      const ViewVector_d meshgrid, const bool PressureGreenFunFlag,
-      std::optional<std::string> VisualizationExportPath)
+      const ViewVector_d meshgrid, const SolverOptions& options)
   {
-    // Initialise the area vector and force vector. Each element contains the
-    // area and force calculated at every iteration.
-    std::vector<double> totalForceVector;
-    std::vector<double> contactAreaVector;
-    double w_el = 0.0;
+    Timings* timings = options.timings;
+    const GreenFunction greenFunction(
+        GridSize, CompositeYoungs, options.far_field_tolerance, options.near_field_radius);
+
+    const bool initialGuessFlag = activeSetf.extent(0) > 0;
 
     // Initialise number of iterations
     int k = 0;
 
-    // Points in contact in the previous iteration (only needed for warmstart)
-    ViewVectorInt_d activeSetf;
-
-    // Contact force at (xvf,yvf) predicted in the previous iteration
-    ViewVector_d pf;
-
     // Difference in total force between current and previous iteration; used as a convergence
     // criterion
     double deltaTotalForce = std::numeric_limits<double>::max();
 
+    // Influence coefficient matrix of the previous iteration and the points it was assembled for,
+    // whose entries are reused by the next assembly
+    ViewMatrix_d previousH;
+    ViewVectorGridIndex_d previousActiveSet0;
+
+    // State of the nonlinear solver at its last solution, from which the next solve restarts
+    NonlinearSolverState nnlsState;
+
+    // Response of the contact forces pf to a uniform shift of the indentation (see
+    // UniformIndentationResponse()), which is valid until the active set activeSetf changes, and
+    // the elastic correction pf was solved for. It is computed with the factorization of H_I of the
+    // last solve, and without it (single precision, GMRES) the closed form is skipped.
+    ViewVector_d shiftResponse;
+    bool shiftResponseValid = false;
+    double solvedW_el = w_el;
+
+    const int N = topology.extent(0);
+
+    // Look the influence coefficients up in the influence kernel of the grid by the grid indices of
+    // the points, which makes their coordinates unnecessary (except for an H-matrix, whose cluster
+    // tree needs them)
+    const bool hierarchical = options.hmatrix_tolerance > 0;
+    const bool kernelLookup = options.kernel_lookup && !hierarchical;
+    ViewMatrix_d kernel;
+    if (kernelLookup)
+    {
+      ScopedTimer timer(timings, "assembly");
+      kernel = SetupInfluenceKernel(N, greenFunction);
+    }
+
     while (deltaTotalForce > Tolerance && k < MaxIteration)
     {
       // Indices of the points predicted to be in contact
-      ViewVectorInt_d activeSet0;
-      // Coordinates of the points predicted to be in contact
+      ViewVectorGridIndex_d activeSet0;
+      // Coordinates of the points predicted to be in contact (without kernel lookup)
       ViewVector_d xv0, yv0;
       // Indentation value of the half space at the predicted points of contact
       ViewVector_d b0;
 
       // First predictor for contact set
-      ContactSetPredictor(activeSet0, xv0, yv0, b0, zmax, Delta, w_el, topology, meshgrid);
+      {
+        ScopedTimer timer(timings, "predictor");
+        if (kernelLookup)
+          ContactSetPredictor(
+              activeSet0, b0, zmax, Delta, w_el, topology, options.space_filling_curve);
+        else
+          ContactSetPredictor(activeSet0, xv0, yv0, b0, zmax, Delta, w_el, topology, meshgrid,
+              options.space_filling_curve);
+      }
 
       // Initial number of predicted contact nodes.
-      const int n0 = activeSet0.extent(0);
+      int n0 = activeSet0.extent(0);
 
-      ViewVector_d p0;
-      if (WarmStartingFlag && k > 0)
+      if (options.statistics && !options.contact_set_estimate)
+        options.statistics->max_predicted_contacts =
+            std::max(options.statistics->max_predicted_contacts, n0);
+
+      // If the active set of the last solution does not change, the elastic correction only shifts
+      // its contact forces, which then follow in closed form without assembling the matrix
+      bool closedForm = false;
+      if (k > 0)
       {
-        // Warmstart
-        // p0 --> contact forces at (xvf,yvf) predicted in the previous iteration but
-        // are a part of currect predicted contact set. p0 is calculated in the
-        // Warmstart function to be used in the NNLS to accelerate the simulation.
-        p0 = Warmstart(activeSet0, activeSetf, pf);
+        ScopedTimer timer(timings, "closed form");
+        if (!shiftResponseValid)
+          shiftResponseValid =
+              UniformIndentationResponse(shiftResponse, nnlsState, greenFunction(0.0, 0.0));
+        const double shift = w_el - solvedW_el;
+        if (shiftResponseValid && kernelLookup)
+          closedForm = ShiftActiveSetSolution(pf, activeSetf, shiftResponse, shift, activeSet0,
+              InfluenceKernelMatrix(activeSet0, kernel), b0);
+        else if (shiftResponseValid)
+          closedForm = ShiftActiveSetSolution(pf, activeSetf, shiftResponse, shift, activeSet0,
+              OnTheFlyMatrix<GreenFunction>(xv0, yv0, greenFunction), b0);
+        if (closedForm && options.statistics) ++options.statistics->closed_form_iterations;
       }
-      else
+
+      if (!closedForm)
       {
-        p0 = ViewVector_d("p0", n0);
-        Kokkos::deep_copy(p0, 0.0);
+        // Solve for an elastic estimate of the contact set within the prediction first, and extend
+        // it by the predicted points it misses until none of them penetrates the half space
+        const ViewVectorGridIndex_d predictedSet0 = activeSet0;
+        const ViewVector_d predictedXv0 = xv0;
+        const ViewVector_d predictedYv0 = yv0;
+        const ViewVector_d predictedB0 = b0;
+        ViewVectorInt_d estimate;
+        if (options.contact_set_estimate)
+        {
+          ScopedTimer timer(timings, "predictor");
+          estimate = EstimateContactSet(predictedSet0, predictedB0, topology);
+        }
+
+        // Initial guess of the nonlinear solver, which the fallback of the estimate extends
+        ViewVector_d p0;
+        bool extended = false;
+        while (true)
+        {
+          if (options.contact_set_estimate)
+          {
+            RestrictContactSet(activeSet0, xv0, yv0, b0, estimate, predictedSet0, predictedXv0,
+                predictedYv0, predictedB0);
+            n0 = activeSet0.extent(0);
+            if (options.statistics)
+              options.statistics->max_predicted_contacts =
+                  std::max(options.statistics->max_predicted_contacts, n0);
+          }
+
+          // Store the influence coefficient matrix unless it is approximated hierarchically or does
+          // not fit into the memory budget; otherwise, its entries are computed whenever they are
+          // needed
+          bool onTheFly = !hierarchical && options.on_the_fly_matrix;
+          const auto estimateMemory = [&](const bool storeMatrix) {
+            return EstimateSolverMemory(
+                N, n0, storeMatrix, options.mixed_precision, kernelLookup, hierarchical);
+          };
+          if (options.memory_budget > 0)
+          {
+            if (!onTheFly && !hierarchical)
+              onTheFly = estimateMemory(true).Total() > options.memory_budget;
+            CheckMemoryBudget(estimateMemory(!onTheFly && !hierarchical), options.memory_budget,
+                "the contact solver for N=" + std::to_string(N) + " with " + std::to_string(n0) +
+                    " predicted contact points");
+          }
+          if (onTheFly && options.statistics) ++options.statistics->on_the_fly_iterations;
+
+          // The factorization of the last active set is kept during the solve, which has to fit
+          // into the memory budget
+          if (options.memory_budget > 0 && nnlsState.factorization.extent(0) > 0 &&
+              estimateMemory(!onTheFly && !hierarchical).Total() +
+                      nnlsState.factorization.span() * sizeof(double) >
+                  options.memory_budget)
+          {
+            nnlsState.factorization = ViewMatrix_d();
+            nnlsState.pivots = ViewVectorInt_d();
+          }
+
+          // After an extension of the estimate, p0 is the initial guess of
+          // ExtendContactSetEstimate()
+          if (!extended && ((WarmStartingFlag && k > 0) || (initialGuessFlag && k == 0)))
+          {
+            ScopedTimer timer(timings, "warmstart");
+            // Warmstart
+            // p0 --> contact forces at (xvf,yvf) predicted in the previous iteration but
+            // are a part of currect predicted contact set. p0 is calculated in the
+            // Warmstart function to be used in the NNLS to accelerate the simulation.
+            p0 = Warmstart(activeSet0, activeSetf, pf);
+          }
+          else if (!extended)
+          {
+            p0 = ViewVector_d("p0", n0);
+            Kokkos::deep_copy(p0, 0.0);
+          }
+
+          ViewMatrix_d H;
+          std::optional<HMatrix> hMatrix;
+          if (hierarchical)
+          {
+            ScopedTimer timer(timings, "assembly");
+            hMatrix.emplace(xv0, yv0, greenFunction, options.hmatrix_tolerance);
+          }
+          else if (!onTheFly)
+          {
+            ScopedTimer timer(timings, "assembly");
+            // Both matrices are kept during the assembly, which has to fit into the memory budget
+            if (options.memory_budget > 0 && previousH.extent(0) > 0 &&
+                estimateMemory(true).Total() + previousH.span() * sizeof(double) >
+                    options.memory_budget)
+              previousH = ViewMatrix_d();
+
+            // A lookup in the kernel is as cheap as a copy from the previous matrix
+            std::size_t reusedEntries = 0;
+            if (kernelLookup)
+              H = SetupMatrix(activeSet0, kernel);
+            else if (previousH.extent(0) > 0)
+              H = UpdateMatrix(previousH, previousActiveSet0, activeSet0, xv0, yv0, greenFunction,
+                  reusedEntries);
+            else
+              H = SetupMatrix(xv0, yv0, greenFunction, n0);
+            previousH = ViewMatrix_d();
+
+            if (options.statistics)
+            {
+              options.statistics->matrix_entries += static_cast<std::size_t>(n0) * n0;
+              options.statistics->reused_matrix_entries += reusedEntries;
+            }
+          }
+
+          // Defined as (u - u(bar)) in (Bemporad & Paggi, 2015)
+          // Gap between the point on the topology and the half space
+          // ViewVector_d w;
+
+          // use Nonlinear solver --> Non-Negative Least Squares (NNLS) as in
+          // (Bemporad & Paggi, 2015)
+          {
+            ScopedTimer timer(timings, "nnls");
+            int nnlsIterations;
+            if (hMatrix)
+              nnlsIterations =
+                  nonlinearSolve(pf, activeSetf, p0, activeSet0, *hMatrix, b0, false, &nnlsState);
+            else if (onTheFly && kernelLookup)
+            {
+              const InfluenceKernelMatrix matrix(activeSet0, kernel);
+              nnlsIterations = nonlinearSolve(pf, activeSetf, p0, activeSet0, matrix, b0,
+                  options.mixed_precision, &nnlsState);
+            }
+            else if (onTheFly)
+            {
+              const OnTheFlyMatrix<GreenFunction> matrix(xv0, yv0, greenFunction);
+              nnlsIterations = nonlinearSolve(pf, activeSetf, p0, activeSet0, matrix, b0,
+                  options.mixed_precision, &nnlsState);
+            }
+            else
+              nnlsIterations = nonlinearSolve(
+                  pf, activeSetf, p0, activeSet0, H, b0, options.mixed_precision, &nnlsState);
+            if (options.statistics) options.statistics->nnls_iterations += nnlsIterations;
+          }
+          shiftResponseValid = false;
+          if (!kernelLookup)
+          {
+            previousH = H;
+            previousActiveSet0 = activeSet0;
+          }
+
+          if (!options.contact_set_estimate) break;
+
+          // p0 holds the contact forces of the points of the estimate
+          int added;
+          {
+            ScopedTimer timer(timings, "predictor");
+            if (kernelLookup)
+              added = ExtendContactSetEstimate(
+                  estimate, p0, InfluenceKernelMatrix(predictedSet0, kernel), predictedB0);
+            else
+              added = ExtendContactSetEstimate(estimate, p0,
+                  OnTheFlyMatrix<GreenFunction>(predictedXv0, predictedYv0, greenFunction),
+                  predictedB0);
+          }
+          if (added == 0) break;
+          extended = true;
+          if (options.statistics)
+          {
+            options.statistics->estimate_added_contacts += added;
+            ++options.statistics->estimate_extensions;
+          }
+        }
       }
-
-      auto H = SetupMatrix(xv0, yv0, GridSize, CompositeYoungs, n0, PressureGreenFunFlag);
-
-      // Defined as (u - u(bar)) in (Bemporad & Paggi, 2015)
-      // Gap between the point on the topology and the half space
-      // ViewVector_d w;
-
-      // use Nonlinear solver --> Non-Negative Least Squares (NNLS) as in
-      // (Bemporad & Paggi, 2015)
-      nonlinearSolve(pf, activeSetf, p0, activeSet0, H, b0);
+      solvedW_el = w_el;
 
       // Compute total contact force and contact area
       double totalForce;
       double contactArea;
-      ComputeContactForceAndArea(
-          totalForce, contactArea, pf, GridSize, LateralLength, PressureGreenFunFlag);
+      ComputeContactForceAndArea<GreenFunction>(
+          totalForce, contactArea, pf, GridSize, LateralLength);
       totalForceVector.push_back(totalForce);
       contactAreaVector.push_back(contactArea);
 
@@ -105,6 +333,78 @@ namespace MIRCO
 
       ++k;
     }
+    if (options.statistics) options.statistics->outer_iterations += k;
+
+    return deltaTotalForce;
+  }
+
+  /**
+   * @brief Evaluate() with the Green function given at compile time
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   */
+  template <typename GreenFunction>
+  void EvaluateWithGreenFunction(double& pressure, double& effectiveContactAreaFraction,
+      const double Delta, const double LateralLength, const double GridSize, const double Tolerance,
+      const int MaxIteration, const double CompositeYoungs, const bool WarmStartingFlag,
+      const double ElasticComplianceCorrection, const ViewMatrix_d topology, const double zmax,
+      const ViewVector_d meshgrid, std::optional<std::string> VisualizationExportPath,
+      const SolverOptions& options)
+  {
+    // Initialise the area vector and force vector. Each element contains the
+    // area and force calculated at every iteration.
+    std::vector<double> totalForceVector;
+    std::vector<double> contactAreaVector;
+    double w_el = 0.0;
+
+    // Points in contact in the previous iteration (only needed for warmstart)
+    ViewVectorGridIndex_d activeSetf;
+
+    // Contact force at (xvf,yvf) predicted in the previous iteration
+    ViewVector_d pf;
+
+    if (options.multilevel_levels > 0)
+    {
+      // Multilevel mode: solve the problem on successively finer grids, starting from the coarsest
+      // one. The converged contact set and contact forces of each level are prolongated to the next
+      // finer level and used as its initial guess, together with the last elastic correction. The
+      // coarse levels use the elastic compliance correction of the actual grid, since they only
+      // serve to provide this initial guess.
+      ScopedTimer timer(options.timings, "coarse levels");
+      const std::vector<ViewMatrix_d> hierarchy =
+          CreateTopologyHierarchy(topology, options.multilevel_levels);
+      const int N = topology.extent(0);
+
+      for (int l = hierarchy.size() - 1; l >= 0; --l)
+      {
+        const ViewMatrix_d topology_l = hierarchy[l];
+        const int N_l = topology_l.extent(0);
+        const double GridSize_l = GridSize * N / N_l;
+        const ViewVector_d meshgrid_l = CreateMeshgrid(N_l, GridSize_l);
+
+        std::vector<double> totalForceVector_l;
+        std::vector<double> contactAreaVector_l;
+        SolveOnGrid<GreenFunction>(totalForceVector_l, contactAreaVector_l, w_el, activeSetf, pf,
+            Delta, LateralLength, GridSize_l, Tolerance, MaxIteration, CompositeYoungs,
+            WarmStartingFlag, ElasticComplianceCorrection, topology_l, zmax, meshgrid_l, options);
+
+        // Point forces have to be scaled with the ratio of the cell areas
+        const double gridSizeRatio = static_cast<double>(N_l) / (2 * N_l - 1);
+        const double scale = GreenFunction::pressure ? 1.0 : gridSizeRatio * gridSizeRatio;
+
+        ScopedTimer timer(options.timings, "prolongation");
+        ViewVectorGridIndex_d activeSet_fine;
+        ViewVector_d p_fine;
+        ProlongateContactSet(activeSet_fine, p_fine, activeSetf, pf, N_l, scale);
+        activeSetf = activeSet_fine;
+        pf = p_fine;
+      }
+    }
+
+    const double deltaTotalForce = SolveOnGrid<GreenFunction>(totalForceVector, contactAreaVector,
+        w_el, activeSetf, pf, Delta, LateralLength, GridSize, Tolerance, MaxIteration,
+        CompositeYoungs, WarmStartingFlag, ElasticComplianceCorrection, topology, zmax, meshgrid,
+        options);
 
     if (deltaTotalForce > Tolerance)
       throw std::runtime_error("The solver did not converge in the maximum number of iterations.");
@@ -124,63 +424,68 @@ namespace MIRCO
     {
 #if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
       std::cout << "Computation finished. Exporting visualization...\n\n";
+      ScopedTimer timer(options.timings, "export");
 
       const int N = topology.extent(0);
-      const int N2 = N * N;
+      if (options.memory_budget > 0)
+        CheckMemoryBudget(EstimateExportMemory(N), options.memory_budget,
+            "the visualization export for N=" + std::to_string(N));
 
       const int na = activeSetf.extent_int(0);
 
       ViewMatrix_d p_m("p_m", N, N);
       Kokkos::deep_copy(p_m, 0);
       Kokkos::parallel_for(
-          na, KOKKOS_LAMBDA(const int indA) {
-            const int a = activeSetf(indA);
+          "Evaluate(); p_m", na, KOKKOS_LAMBDA(const int indA) {
+            const GridIndex_t a = activeSetf(indA);
             p_m(a % N, a / N) = pf(indA);
           });
 
-      ViewMatrix_d u_m("u_m", N, N);
-      Kokkos::parallel_for(
-          Kokkos::TeamPolicy<ExecSpace_Default_t>(N2, Kokkos::AUTO),
-          KOKKOS_LAMBDA(const Kokkos::TeamPolicy<ExecSpace_Default_t>::member_type& team) {
-            const int iInd = team.league_rank();
-            const int ix = iInd % N;
-            const int iy = iInd / N;
-
-            double sum = 0.0;
-
-            Kokkos::parallel_reduce(
-                Kokkos::TeamThreadRange(team, na),
-                [&](const int k, double& lsum)
-                {
-                  const int jInd = activeSetf(k);
-                  const int jx = jInd % N;
-                  const int jy = jInd / N;
-
-                  lsum += SetupMatrixOneEntry(
-                              ix, iy, jx, jy, GridSize, CompositeYoungs, N, PressureGreenFunFlag) *
-                          p_m(jx, jy);
-                },
-                sum);
-
-            Kokkos::single(Kokkos::PerTeam(team), [&] { u_m(ix, iy) = sum; });
-          });
+      const ViewMatrix_d u_m = ComputeDisplacementField(p_m, GreenFunction(GridSize,
+          CompositeYoungs, options.far_field_tolerance, options.near_field_radius));
 
       double max_u = GetMax(u_m);
       ViewMatrix_d deformedHalfSpace("deformedHalfSpace", N, N);
       Kokkos::deep_copy(deformedHalfSpace, Delta);
-      Kokkos::parallel_for(
+      Kokkos::parallel_for("Evaluate(); deformedHalfSpace",
           Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {N, N}),
           KOKKOS_LAMBDA(
               const int i, const int j) { deformedHalfSpace(i, j) = zmax - max_u + u_m(i, j); });
 
-      ExportVisualization(VisualizationExportPath.value(), GridSize, activeSetf,
-          {u_m, p_m, topology, deformedHalfSpace},
-          {"Displacement", "Pressure", "Topology (Rigid Indentor)", "Deformed Elastic Half-Space"});
+      const std::vector<ViewMatrix_d> fields = {u_m, p_m, topology, deformedHalfSpace};
+      const std::vector<std::string> fieldNames = {
+          "Displacement", "Pressure", "Topology (Rigid Indentor)", "Deformed Elastic Half-Space"};
+      if (options.visualization_writer)
+        options.visualization_writer->Submit(VisualizationExportPath.value(), Delta, GridSize,
+            activeSetf, fields, fieldNames, options.visualization_double_precision,
+            options.visualization_compression_level);
+      else
+        ExportVisualization(VisualizationExportPath.value(), GridSize, activeSetf, fields,
+            fieldNames, options.visualization_double_precision,
+            options.visualization_compression_level);
 #else
       std::cerr << "WARNING: Unable to export visualization; CMake variable "
                    "MIRCO_ENABLE_VISUALIZATIONEXPORT is OFF.\n\n";
 #endif
     }
   }
+}  // namespace
 
+namespace MIRCO
+{
+  void Evaluate(double& pressure, double& effectiveContactAreaFraction, const double Delta,
+      const double LateralLength, const double GridSize, const double Tolerance,
+      const int MaxIteration, const double CompositeYoungs, const bool WarmStartingFlag,
+      const double ElasticComplianceCorrection, const ViewMatrix_d topology, const double zmax,
+      const ViewVector_d meshgrid, const bool PressureGreenFunFlag,
+      std::optional<std::string> VisualizationExportPath, const SolverOptions& options)
+  {
+    // The only branch on the kind of Green function; all kernels below are specialized for it
+    DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      EvaluateWithGreenFunction<typename decltype(tag)::type>(pressure,
+          effectiveContactAreaFraction, Delta, LateralLength, GridSize, Tolerance, MaxIteration,
+          CompositeYoungs, WarmStartingFlag, ElasticComplianceCorrection, topology, zmax, meshgrid,
+          VisualizationExportPath, options);
+    });
+  }
 }  // namespace MIRCO
@@ -3,6 +3,7 @@
 
 #include "mirco_inputparameters.h"
 #include "mirco_kokkostypes.h"
+#include "mirco_solveroptions.h"
 
 namespace MIRCO
 {
@@ -25,13 +26,15 @@ namespace MIRCO
    * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead of
    * point force
    * @param[in] ExportVisualizationPath Path to export visualization files to
+   * @param[in] options Optional algorithmic settings
    */
   void Evaluate(double& pressure, double& effectiveContactAreaFraction, const double Delta,
       const double LateralLength, const double GridSize, const double Tolerance,
       const int MaxIteration, const double CompositeYoungs, const bool WarmStartingFlag,
       const double ElasticComplianceCorrection, const ViewMatrix_d topology, const double zmax,
       const ViewVector_d meshgrid, const bool PressureGreenFunFlag,
-      std::optional<std::string> VisualizationExportPath = std::nullopt);
+      std::optional<std::string> VisualizationExportPath = std::nullopt,
+      const SolverOptions& options = SolverOptions());
 
   /**
    * @brief Relate the far-field displacement with pressure, taking the parameters from an
@@ -50,7 +53,8 @@ namespace MIRCO
         inputParams.grid_size, inputParams.tolerance, inputParams.max_iteration,
         inputParams.composite_youngs, inputParams.warm_starting_flag,
         inputParams.elastic_compliance_correction, inputParams.topology, zmax, meshgrid,
-        inputParams.pressure_green_funct_flag, inputParams.export_visualization_path);
+        inputParams.pressure_green_funct_flag, inputParams.export_visualization_path,
+        inputParams.solver_options);
   }
 }  // namespace MIRCO
 
@@ -1,45 +1,121 @@
 #include "mirco_exportvisualization.h"
 
+#include <vtkDoubleArray.h>
 #include <vtkFloatArray.h>
 #include <vtkImageData.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
+#include <vtkSmartPointer.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkXMLImageDataWriter.h>
 #include <vtkZLibDataCompressor.h>
 
-#include <cstring>  // for memset
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-namespace MIRCO
+namespace
 {
-  void ExportVisualization(const std::string& path, float gridSize, const ViewVectorInt_d activeSet,
-      const std::vector<ViewMatrix_d>& otherFields, const std::vector<std::string>& otherFieldNames)
+  using namespace MIRCO;
+
+  template <typename T>
+  using UnmanagedVector_h =
+      Kokkos::View<T*, MemorySpace_Host_t, Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+  template <typename T>
+  using UnmanagedMatrix_h = Kokkos::View<T**, Kokkos::LayoutLeft, MemorySpace_Host_t,
+      Kokkos::MemoryTraits<Kokkos::Unmanaged>>;
+
+  /**
+   * @brief Add a field to the point data of the image. VTK expects the values of point (i, j) at
+   * index i + n * j, which is the memory layout of the (LayoutLeft) field, so no reordering is
+   * necessary.
+   *
+   * @tparam VtkArrayType vtkFloatArray or vtkDoubleArray
+   * @param[in] snapshot Always copy the values, such that the image does not reference the field
+   */
+  template <typename VtkArrayType>
+  void AddField(
+      vtkImageData* img, const ViewMatrix_d field, const std::string& name, const bool snapshot)
+  {
+    using ValueType = typename VtkArrayType::ValueType;
+    constexpr bool hostAccessible =
+        Kokkos::SpaceAccessibility<MemorySpace_Host_t, MemorySpace_ofDefaultExec_t>::accessible;
+
+    const int n = field.extent(0);
+    const vtkIdType n2 = static_cast<vtkIdType>(n) * n;
+
+    vtkNew<VtkArrayType> vtkArr;
+    vtkArr->SetName(name.c_str());
+    vtkArr->SetNumberOfComponents(1);
+
+    if constexpr (std::is_same_v<ValueType, double>)
+    {
+      if (hostAccessible && !snapshot)
+      {
+        // Hand the allocation of the field to VTK (save = 1, i.e. VTK does not free it). The field
+        // outlives the writer, since it is held by the caller.
+        vtkArr->SetArray(field.data(), n2, 1);
+      }
+      else
+      {
+        vtkArr->SetNumberOfTuples(n2);
+        Kokkos::deep_copy(UnmanagedMatrix_h<double>(vtkArr->GetPointer(0), n, n), field);
+      }
+    }
+    else
+    {
+      vtkArr->SetNumberOfTuples(n2);
+      UnmanagedVector_h<ValueType> buffer(vtkArr->GetPointer(0), n2);
+      const ViewMatrix_h field_h = Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(), field);
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<ExecSpace_DefaultHost_t, Kokkos::IndexType<vtkIdType>>(0, n2),
+          KOKKOS_LAMBDA(const vtkIdType k) {
+            buffer(k) = static_cast<ValueType>(field_h(k % n, k / n));
+          });
+    }
+
+    img->GetPointData()->AddArray(vtkArr);
+  }
+
+  /**
+   * @brief Create the image data of the active set and the given fields (see ExportVisualization())
+   *
+   * @param[in] snapshot Copy all values, such that the image is independent of the fields
+   */
+  vtkSmartPointer<vtkImageData> CreateImageData(float gridSize,
+      const ViewVectorGridIndex_d activeSet, const std::vector<ViewMatrix_d>& otherFields,
+      const std::vector<std::string>& otherFieldNames, const bool doublePrecision,
+      const bool snapshot)
   {
     const int n = otherFields[0].extent(0);
-    const int n2 = n * n;
+    const vtkIdType n2 = static_cast<vtkIdType>(n) * n;
 
-    vtkNew<vtkImageData> img;
+    auto img = vtkSmartPointer<vtkImageData>::New();
     img->SetDimensions(n, n, 1);
     img->SetSpacing(gridSize, gridSize, 1.0);
     img->SetOrigin(0.0, 0.0, 0.0);
 
     // Active set
     {
-      ViewVectorInt_h activeSet_h =
-          Kokkos::create_mirror_view_and_copy(ExecSpace_DefaultHost_t(), activeSet);
+      const ViewVectorGridIndex_h activeSet_h =
+          Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(), activeSet);
 
       vtkNew<vtkUnsignedCharArray> vtkArr;
       vtkArr->SetName("Active Set");
       vtkArr->SetNumberOfComponents(1);
       vtkArr->SetNumberOfTuples(n2);
 
-      auto* vtkArrArr = static_cast<unsigned char*>(vtkArr->WriteVoidPointer(0, n2));
-      std::memset(vtkArrArr, 0, static_cast<size_t>(n2));
-
-      for (int indA = 0; indA < activeSet_h.extent(0); ++indA)
-        vtkArr->SetValue(activeSet_h(indA), 1);
+      UnmanagedVector_h<unsigned char> flags(vtkArr->GetPointer(0), n2);
+      Kokkos::deep_copy(flags, 0);
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<ExecSpace_DefaultHost_t>(0, activeSet_h.extent(0)),
+          KOKKOS_LAMBDA(const int indA) { flags(activeSet_h(indA)) = 1; });
 
       img->GetPointData()->AddArray(vtkArr);
     }
@@ -47,26 +123,38 @@ namespace MIRCO
     // Other fields
     for (int f = 0; f < otherFields.size(); ++f)
     {
-      ViewMatrix_h field_h =
-          Kokkos::create_mirror_view_and_copy(ExecSpace_DefaultHost_t(), otherFields[f]);
-
-      vtkNew<vtkFloatArray> vtkArr;
-      vtkArr->SetName(otherFieldNames[f].c_str());
-      vtkArr->SetNumberOfComponents(1);
-      vtkArr->SetNumberOfTuples(n2);
+      if (doublePrecision)
+        AddField<vtkDoubleArray>(img, otherFields[f], otherFieldNames[f], snapshot);
+      else
+        AddField<vtkFloatArray>(img, otherFields[f], otherFieldNames[f], snapshot);
+    }
 
-      for (int i = 0; i < n; ++i)
-        for (int j = 0; j < n; ++j) vtkArr->SetValue(i + n * j, field_h(i, j));
+    // The parallel fills run asynchronously on the host execution space
+    Kokkos::fence();
 
-      img->GetPointData()->AddArray(vtkArr);
-    }
+    return img;
+  }
 
+  /**
+   * @brief Serialize and compress the image data to the file path.vti. Only VTK is used here, so
+   * this function may be called from any thread.
+   */
+  void WriteImageData(vtkImageData* img, const std::string& path, const int compressionLevel)
+  {
     vtkNew<vtkXMLImageDataWriter> w;
     w->SetFileName((path + ".vti").c_str());
     w->SetInputData(img);
 
-    vtkNew<vtkZLibDataCompressor> z;
-    w->SetCompressor(z);
+    if (compressionLevel > 0)
+    {
+      vtkNew<vtkZLibDataCompressor> z;
+      z->SetCompressionLevel(compressionLevel);
+      w->SetCompressor(z);
+    }
+    else
+    {
+      w->SetCompressorTypeToNone();
+    }
     w->SetDataModeToAppended();
     w->EncodeAppendedDataOff();
 
@@ -75,4 +163,143 @@ namespace MIRCO
       std::cerr << "WARNING: ExportVisualization() failed to write to file\n\n";
     }
   }
+
+  /**
+   * @brief Write a ParaView data (.pvd) file, which collects the given files as a time series.
+   * The file is first written to a temporary file and then renamed, such that readers never see a
+   * partially written collection.
+   *
+   * @param[in] path Path of the collection without the extension .pvd
+   * @param[in] entries Time and path (without the extension .vti) of every file
+   */
+  void WriteCollection(
+      const std::string& path, const std::vector<std::pair<double, std::string>>& entries)
+  {
+    const std::filesystem::path pvdPath = std::filesystem::absolute(path + ".pvd");
+    const std::filesystem::path tmpPath = pvdPath.string() + ".tmp";
+    {
+      std::ofstream out(tmpPath);
+      if (!out) throw std::runtime_error("Cannot open file: " + tmpPath.string());
+
+      out << std::setprecision(16);
+      out << "<?xml version=\"1.0\"?>\n";
+      out << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+      out << "  <Collection>\n";
+      for (const auto& [time, file] : entries)
+      {
+        // Files are referenced relative to the collection, so that it can be moved with them
+        const std::filesystem::path vtiPath =
+            std::filesystem::absolute(file + ".vti").lexically_relative(pvdPath.parent_path());
+        out << "    <DataSet timestep=\"" << time << "\" group=\"\" part=\"0\" file=\""
+            << vtiPath.generic_string() << "\"/>\n";
+      }
+      out << "  </Collection>\n";
+      out << "</VTKFile>\n";
+    }
+    std::filesystem::rename(tmpPath, pvdPath);
+  }
+}  // namespace
+
+namespace MIRCO
+{
+  void ExportVisualization(const std::string& path, float gridSize,
+      const ViewVectorGridIndex_d activeSet, const std::vector<ViewMatrix_d>& otherFields,
+      const std::vector<std::string>& otherFieldNames,
+      const bool doublePrecision, const int compressionLevel)
+  {
+    const vtkSmartPointer<vtkImageData> img =
+        CreateImageData(gridSize, activeSet, otherFields, otherFieldNames, doublePrecision, false);
+    WriteImageData(img, path, compressionLevel);
+  }
+
+  AsyncVisualizationWriter::AsyncVisualizationWriter(
+      const int maxQueuedSnapshots, const std::optional<std::string>& collectionPath)
+      : maxQueued_(maxQueuedSnapshots), collectionPath_(collectionPath)
+  {
+    if (maxQueuedSnapshots < 1)
+      throw std::runtime_error("AsyncVisualizationWriter needs room for at least one snapshot");
+
+    writerThread_ = std::thread([this]() { Run(); });
+  }
+
+  AsyncVisualizationWriter::~AsyncVisualizationWriter()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    changed_.notify_all();
+    // The writer thread finishes all queued snapshots before it returns
+    writerThread_.join();
+  }
+
+  void AsyncVisualizationWriter::Submit(const std::string& path, const double time,
+      float gridSize, const ViewVectorGridIndex_d activeSet,
+      const std::vector<ViewMatrix_d>& otherFields, const std::vector<std::string>& otherFieldNames,
+      const bool doublePrecision, const int compressionLevel)
+  {
+    // Backpressure: reserve a place in the queue before the snapshot is taken, such that at most
+    // maxQueued_ snapshots wait for the writer thread
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [this]() { return queue_.size() + reserved_ < maxQueued_; });
+      ++reserved_;
+    }
+
+    vtkSmartPointer<vtkImageData> img =
+        CreateImageData(gridSize, activeSet, otherFields, otherFieldNames, doublePrecision, true);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --reserved_;
+      queue_.push_back([this, img, path, time, compressionLevel]() {
+        WriteImageData(img, path, compressionLevel);
+        if (collectionPath_)
+        {
+          collection_.emplace_back(time, path);
+          WriteCollection(collectionPath_.value(), collection_);
+        }
+      });
+    }
+    changed_.notify_all();
+  }
+
+  void AsyncVisualizationWriter::Wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this]() { return queue_.empty() && reserved_ == 0 && !writing_; });
+  }
+
+  void AsyncVisualizationWriter::Run()
+  {
+    while (true)
+    {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        job = std::move(queue_.front());
+        queue_.pop_front();
+        writing_ = true;
+      }
+      // A place in the queue became available
+      changed_.notify_all();
+
+      try
+      {
+        job();
+      }
+      catch (const std::exception& e)
+      {
+        std::cerr << "WARNING: AsyncVisualizationWriter failed to write: " << e.what() << "\n\n";
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+      }
+      changed_.notify_all();
+    }
+  }
 }  // namespace MIRCO
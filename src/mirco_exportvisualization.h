@@ -1,15 +1,113 @@
 #ifndef SRC_EXPORTVISUALIZATION_H_
 #define SRC_EXPORTVISUALIZATION_H_
 
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "mirco_kokkostypes.h"
 
 namespace MIRCO
 {
-  void ExportVisualization(const std::string& path, float gridSize, const ViewVectorInt_d activeSet,
-      const std::vector<ViewMatrix_d>& otherFields,
-      const std::vector<std::string>& otherFieldNames);
+  /**
+   * @brief Export the active set and the given fields of an N x N grid to a VTK image data file
+   *
+   * The fields are written directly into the VTK arrays with parallel fills. In double precision,
+   * VTK uses host-accessible fields without any copy.
+   *
+   * @param[in] path Path of the output file without the extension .vti
+   * @param[in] gridSize Grid size (length of each cell)
+   * @param[in] activeSet Indices of the points in contact
+   * @param[in] otherFields Fields to export
+   * @param[in] otherFieldNames Names of the fields to export
+   * @param[in] doublePrecision Write the fields in double instead of single precision
+   * @param[in] compressionLevel zlib compression level (0 to 9, 0 disables the compression)
+   */
+  void ExportVisualization(const std::string& path, float gridSize,
+      const ViewVectorGridIndex_d activeSet, const std::vector<ViewMatrix_d>& otherFields,
+      const std::vector<std::string>& otherFieldNames,
+      const bool doublePrecision = false, const int compressionLevel = 5);
+
+  /**
+   * @brief Asynchronous output queue for visualization exports
+   *
+   * Submit() takes a host snapshot of the fields on the calling thread and hands it to a dedicated
+   * writer thread, which serializes and compresses it while the caller continues with its
+   * computation. The number of snapshots waiting for the writer thread is bounded: Submit() blocks
+   * while the queue is full (backpressure), which bounds the memory used by the snapshots.
+   *
+   * Optionally, a ParaView data (.pvd) collection is kept up to date, which references all written
+   * files with their times, e.g. for a series of load steps.
+   */
+  class AsyncVisualizationWriter
+  {
+   public:
+    /**
+     * @param[in] maxQueuedSnapshots Maximum number of snapshots waiting for the writer thread
+     * @param[in] collectionPath Path of the .pvd collection without the extension, or std::nullopt
+     * to not write a collection
+     */
+    explicit AsyncVisualizationWriter(const int maxQueuedSnapshots = 2,
+        const std::optional<std::string>& collectionPath = std::nullopt);
+
+    /**
+     * @brief Write all remaining snapshots and stop the writer thread
+     */
+    ~AsyncVisualizationWriter();
+
+    AsyncVisualizationWriter(const AsyncVisualizationWriter&) = delete;
+    AsyncVisualizationWriter& operator=(const AsyncVisualizationWriter&) = delete;
+
+    /**
+     * @brief Queue the export of the active set and the given fields, see ExportVisualization().
+     * The fields may be modified as soon as this function returns.
+     *
+     * @param[in] path Path of the output file without the extension .vti
+     * @param[in] time Time (or load step) of the snapshot in the .pvd collection
+     * @param[in] gridSize Grid size (length of each cell)
+     * @param[in] activeSet Indices of the points in contact
+     * @param[in] otherFields Fields to export
+     * @param[in] otherFieldNames Names of the fields to export
+     * @param[in] doublePrecision Write the fields in double instead of single precision
+     * @param[in] compressionLevel zlib compression level (0 to 9, 0 disables the compression)
+     */
+    void Submit(const std::string& path, const double time, float gridSize,
+        const ViewVectorGridIndex_d activeSet, const std::vector<ViewMatrix_d>& otherFields,
+        const std::vector<std::string>& otherFieldNames, const bool doublePrecision = false,
+        const int compressionLevel = 5);
+
+    /**
+     * @brief Block until all submitted snapshots are written
+     */
+    void Wait();
+
+   private:
+    // Main loop of the writer thread
+    void Run();
+
+    const std::size_t maxQueued_;
+    const std::optional<std::string> collectionPath_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<std::function<void()>> queue_;
+    // Places in the queue reserved by Submit() calls which are taking their snapshot
+    std::size_t reserved_ = 0;
+    bool writing_ = false;
+    bool stop_ = false;
+
+    // Time and path of all written files (only accessed by the writer thread)
+    std::vector<std::pair<double, std::string>> collection_;
+
+    std::thread writerThread_;
+  };
 }  // namespace MIRCO
 
 #endif  // SRC_EXPORTVISUALIZATION_H_
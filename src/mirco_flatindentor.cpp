@@ -0,0 +1,217 @@
+#include "mirco_flatindentor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "mirco_influenceoperator.h"
+
+namespace
+{
+  using namespace MIRCO;
+
+  using RangePolicy_t = Kokkos::RangePolicy<ExecSpace_Default_t>;
+
+  // Index of the symmetry-reduced unknown which represents grid point (i, j). The solution of the
+  // flat indentor problem on a square grid is symmetric with respect to both midlines and both
+  // diagonals, so only the points (r, s) with 0 <= r <= s < (N + 1) / 2 are independent.
+  KOKKOS_INLINE_FUNCTION int ReducedIndex(const int i, const int j, const int N)
+  {
+    const int ii = i < N - 1 - i ? i : N - 1 - i;
+    const int jj = j < N - 1 - j ? j : N - 1 - j;
+    const int r = ii < jj ? ii : jj;
+    const int s = ii < jj ? jj : ii;
+    return s * (s + 1) / 2 + r;
+  }
+
+  // Fill the full grid vector from the symmetry-reduced vector
+  void Expand(const ExecSpace_Default_t& exec, ViewVector_d full, const ViewVector_d reduced,
+      const int N)
+  {
+    Kokkos::parallel_for(
+        GridRangePolicy_t(exec, 0, static_cast<GridIndex_t>(N) * N),
+        KOKKOS_LAMBDA(const GridIndex_t a) { full(a) = reduced(ReducedIndex(a / N, a % N, N)); });
+  }
+
+  // Extract the symmetry-reduced vector from a symmetric full grid vector
+  void Restrict(const ExecSpace_Default_t& exec, ViewVector_d reduced, const ViewVector_d full,
+      const int N)
+  {
+    const int K = (N + 1) / 2;
+    Kokkos::parallel_for(
+        GridRangePolicy_t(exec, 0, static_cast<GridIndex_t>(N) * N),
+        KOKKOS_LAMBDA(const GridIndex_t a) {
+          const int i = a / N;
+          const int j = a % N;
+          if (i <= j && j < K) reduced(ReducedIndex(i, j, N)) = full(a);
+        });
+  }
+
+  // Inner product of the full grid vectors, i.e. weighted with the number of grid points each
+  // reduced unknown represents
+  double WeightedDot(const ExecSpace_Default_t& exec, const ViewVector_d a, const ViewVector_d b,
+      const ViewVector_d weights)
+  {
+    double result = 0.0;
+    Kokkos::parallel_reduce(
+        RangePolicy_t(exec, 0, a.extent(0)),
+        KOKKOS_LAMBDA(const int k, double& sum) { sum += weights(k) * a(k) * b(k); }, result);
+    return result;
+  }
+}  // namespace
+
+MIRCO::ViewVector_d MIRCO::SolveFlatIndentor(const int N, const double Delta,
+    const double CompositeYoungs, const double LateralLength, const bool PressureGreenFunFlag,
+    const double Tolerance, const ExecSpace_Default_t& exec)
+{
+  if (N <= 0)
+    throw std::runtime_error("Cannot solve the flat indentor problem for N=" + std::to_string(N));
+
+  const double GridSize = LateralLength / N;
+  const GridIndex_t N2 = static_cast<GridIndex_t>(N) * N;
+  const int K = (N + 1) / 2;
+  const int nReduced = K * (K + 1) / 2;
+
+  InfluenceOperator H(N, GridSize, CompositeYoungs, PressureGreenFunFlag, exec);
+
+  ViewVector_d weights(Kokkos::view_alloc(exec, "SolveFlatIndentor(); weights"), nReduced);
+  Kokkos::parallel_for(
+      GridRangePolicy_t(exec, 0, N2), KOKKOS_LAMBDA(const GridIndex_t a) {
+        Kokkos::atomic_add(&weights(ReducedIndex(a / N, a % N, N)), 1.0);
+      });
+
+  // Conjugate gradient method for H p = Delta in the space of symmetric grid vectors with the
+  // initial guess p = 0. Since H commutes with the symmetry operations, the iterates are identical
+  // to the ones of the conjugate gradient method for the full grid.
+  ViewVector_d p(Kokkos::view_alloc(exec, "SolveFlatIndentor(); p"), nReduced);
+  ViewVector_d r(Kokkos::view_alloc(exec, "SolveFlatIndentor(); r"), nReduced);
+  ViewVector_d d(Kokkos::view_alloc(exec, "SolveFlatIndentor(); d"), nReduced);
+  ViewVector_d q(Kokkos::view_alloc(exec, "SolveFlatIndentor(); q"), nReduced);
+  ViewVector_d dFull(Kokkos::view_alloc(exec, "SolveFlatIndentor(); dFull"), N2);
+  ViewVector_d qFull(Kokkos::view_alloc(exec, "SolveFlatIndentor(); qFull"), N2);
+  Kokkos::deep_copy(exec, r, Delta);
+  Kokkos::deep_copy(exec, d, Delta);
+
+  const double rr0 = WeightedDot(exec, r, r, weights);
+  double rr = rr0;
+  bool converged = false;
+  // In exact arithmetic, the method converges in at most nReduced iterations
+  for (int iter = 0; iter < nReduced + 100; ++iter)
+  {
+    Expand(exec, dFull, d, N);
+    H.Apply(qFull, dFull);
+    Restrict(exec, q, qFull, N);
+
+    const double alpha = rr / WeightedDot(exec, d, q, weights);
+    Kokkos::parallel_for(
+        RangePolicy_t(exec, 0, nReduced), KOKKOS_LAMBDA(const int k) {
+          p(k) += alpha * d(k);
+          r(k) -= alpha * q(k);
+        });
+
+    const double rr_new = WeightedDot(exec, r, r, weights);
+    if (std::sqrt(rr_new / rr0) < Tolerance)
+    {
+      converged = true;
+      break;
+    }
+
+    const double beta = rr_new / rr;
+    rr = rr_new;
+    Kokkos::parallel_for(
+        RangePolicy_t(exec, 0, nReduced),
+        KOKKOS_LAMBDA(const int k) { d(k) = r(k) + beta * d(k); });
+  }
+  if (!converged)
+    throw std::runtime_error(
+        "The flat indentor problem did not converge for N=" + std::to_string(N));
+
+  ViewVector_d pFull(Kokkos::view_alloc(exec, "SolveFlatIndentor(); pFull"), N2);
+  Expand(exec, pFull, p, N);
+  exec.fence();
+  return pFull;
+}
+
+double MIRCO::ComputeShapeFactor(const int N, const bool PressureGreenFunFlag,
+    const double Tolerance, const ExecSpace_Default_t& exec)
+{
+  // The shape factor is dimensionless, so the flat indentor problem is solved for unit values
+  constexpr double Delta = 1.0;
+  constexpr double CompositeYoungs = 1.0;
+  constexpr double LateralLength = 1.0;
+
+  const ViewVector_d p = SolveFlatIndentor(
+      N, Delta, CompositeYoungs, LateralLength, PressureGreenFunFlag, Tolerance, exec);
+
+  double sum = 0.0;
+  Kokkos::parallel_reduce(
+      GridRangePolicy_t(exec, 0, static_cast<GridIndex_t>(N) * N),
+      KOKKOS_LAMBDA(const GridIndex_t a, double& local_sum) { local_sum += p(a); }, sum);
+
+  // Same as in ComputeContactForceAndArea()
+  const double GridSize = LateralLength / N;
+  const double totalForce = PressureGreenFunFlag ? sum * GridSize * GridSize : sum;
+
+  // w_{el} = Delta = meanPressure * l * \alpha / CompositeYoungs
+  return Delta * CompositeYoungs * LateralLength / totalForce;
+}
+
+void MIRCO::ComputeShapeFactors(const std::vector<int>& Ns, const bool PressureGreenFunFlag,
+    const std::function<void(const int, const double)>& onResult, const double Tolerance,
+    int nPartitions)
+{
+  // Grids up to this size (i.e. FFTs of at most 256 x 256 entries) are too small to occupy the
+  // entire execution space
+  constexpr int maxConcurrentN = 129;
+
+  std::vector<int> smallNs;
+  std::vector<int> largeNs;
+  for (const int N : Ns) (N <= maxConcurrentN ? smallNs : largeNs).push_back(N);
+
+  if (nPartitions <= 0) nPartitions = std::max(1u, std::thread::hardware_concurrency());
+  nPartitions = std::min(nPartitions, static_cast<int>(smallNs.size()));
+
+  std::mutex resultMutex;
+  if (nPartitions > 0)
+  {
+    const std::vector<ExecSpace_Default_t> partitions = Kokkos::Experimental::partition_space(
+        ExecSpace_Default_t(), std::vector<int>(nPartitions, 1));
+
+    // Every worker thread takes the next small N as soon as it is done with the previous one
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::vector<std::thread> workers;
+    for (int w = 0; w < nPartitions; ++w)
+    {
+      workers.emplace_back(
+          [&, w]() {
+            try
+            {
+              for (std::size_t k = next++; k < smallNs.size() && !failed; k = next++)
+              {
+                const double shapeFactor =
+                    ComputeShapeFactor(smallNs[k], PressureGreenFunFlag, Tolerance, partitions[w]);
+                std::lock_guard<std::mutex> lock(resultMutex);
+                onResult(smallNs[k], shapeFactor);
+              }
+            }
+            catch (...)
+            {
+              std::lock_guard<std::mutex> lock(resultMutex);
+              if (!error) error = std::current_exception();
+              failed = true;
+            }
+          });
+    }
+    for (auto& worker : workers) worker.join();
+    if (error) std::rethrow_exception(error);
+  }
+
+  for (const int N : largeNs) onResult(N, ComputeShapeFactor(N, PressureGreenFunFlag, Tolerance));
+}
@@ -0,0 +1,72 @@
+#ifndef SRC_FLATINDENTOR_H_
+#define SRC_FLATINDENTOR_H_
+
+#include <functional>
+#include <vector>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  /**
+   * @brief Solve the flat indentor problem, i.e. H p = Delta for the entire grid being in contact.
+   *
+   * A matrix-free conjugate gradient method is used, in which the influence coefficient matrix is
+   * applied with fast Fourier transforms (see InfluenceOperator). Only the unknowns which are
+   * independent due to the 8-fold symmetry of the square grid are iterated on, such that the memory
+   * requirements scale with N^2 instead of N^4 as for the dense solve.
+   *
+   * @param[in] N Element count along one direction
+   * @param[in] Delta Far-field displacement (Gap)
+   * @param[in] CompositeYoungs The composite Young's modulus
+   * @param[in] LateralLength Lateral side of the surface [micrometers]
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   * @param[in] Tolerance Relative residual tolerance of the conjugate gradient method
+   * @param[in] exec Execution space instance to run on
+   *
+   * @return Contact forces (or pressures) of all N * N grid points
+   */
+  ViewVector_d SolveFlatIndentor(const int N, const double Delta, const double CompositeYoungs,
+      const double LateralLength, const bool PressureGreenFunFlag, const double Tolerance = 1e-13,
+      const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+  /**
+   * @brief Compute the shape factor for a grid with N elements along one direction by solving the
+   * flat indentor problem (See section 3.3 of https://doi.org/10.1007/s00466-019-01791-3) with
+   * SolveFlatIndentor().
+   *
+   * @param[in] N Element count along one direction
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   * @param[in] Tolerance Relative residual tolerance of the conjugate gradient method
+   * @param[in] exec Execution space instance to run on
+   *
+   * @return Shape factor alpha = Delta * CompositeYoungs * LateralLength / totalForce
+   */
+  double ComputeShapeFactor(const int N, const bool PressureGreenFunFlag,
+      const double Tolerance = 1e-13, const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+  /**
+   * @brief Compute the shape factors for several N with ComputeShapeFactor().
+   *
+   * Small grids cannot exploit the entire execution space, so they are solved concurrently: the
+   * default execution space is partitioned into nPartitions instances, each of which is used by one
+   * host thread that repeatedly takes the next small N. Large grids are afterwards solved one at a
+   * time on the entire execution space.
+   *
+   * @param[in] Ns Element counts along one direction
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   * @param[in] onResult Called with N and the shape factor as soon as it is available. The calls
+   * are in arbitrary order, but never concurrent.
+   * @param[in] Tolerance Relative residual tolerance of the conjugate gradient method
+   * @param[in] nPartitions Number of concurrent solves for small N. The default (0) is the number
+   * of hardware threads.
+   */
+  void ComputeShapeFactors(const std::vector<int>& Ns, const bool PressureGreenFunFlag,
+      const std::function<void(const int, const double)>& onResult,
+      const double Tolerance = 1e-13, int nPartitions = 0);
+}  // namespace MIRCO
+
+#endif  // SRC_FLATINDENTOR_H_
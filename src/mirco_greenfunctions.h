@@ -0,0 +1,449 @@
+#ifndef SRC_GREENFUNCTIONS_H_
+#define SRC_GREENFUNCTIONS_H_
+
+#include <math.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "mirco_kokkostypes.h"
+
+// The overloads of the math functions for SIMD vectors have to be declared before the Green
+// functions
+#if KOKKOS_VERSION >= 40000
+#include <Kokkos_SIMD.hpp>
+#endif
+
+namespace MIRCO
+{
+  /*
+   * Green functions of the elastic half-space, i.e. the influence coefficient H(i, j) of two grid
+   * points, as compile-time policies. Every policy provides
+   *  - a constructor taking the grid size, the composite Young's modulus and optionally the
+   *    settings of the far-field approximation (see below),
+   *  - GridSize(), the grid size,
+   *  - operator()(dx, dy), the influence coefficient of two points with the distances dx and dy in
+   *    x- and y-direction (including dx = dy = 0),
+   *  - Evaluate(dx, dy), the same for two distinct points, templated on the value type such that
+   *    it can be evaluated for a SIMD vector of distances, and Self(), the influence coefficient of
+   *    a point on itself,
+   *  - EvaluateExact(dx, dy) and EvaluateFarField(dx, dy), between which Evaluate() selects, and
+   *    FarFieldErrorBound(rho), a bound of the relative error of EvaluateFarField() at a distance
+   *    of rho cells,
+   *  - pressure: whether the unknowns are pressures (forces per cell area) instead of forces,
+   *  - symmetric: whether operator() is bitwise symmetric in the order of the two points, such
+   *    that only one half of a matrix has to be evaluated,
+   *  - name: a description for the labels of the kernels.
+   *
+   * The kernels are templates of the policy, such that they are compiled without any branch on the
+   * kind of Green function. A new Green function only needs a new policy, which is added to
+   * DispatchGreenFunction() and to the explicit instantiations of the kernels.
+   *
+   * Far-field approximation: beyond the near-field radius, the exact Green function is replaced by
+   * its asymptotic expansion in the grid size over the distance, which needs a single square root
+   * instead of eight square roots and four logarithms (pressure) or an arcsine (point force). The
+   * near-field radius is the smallest distance at which the error bound is below the tolerance,
+   * but at least the given minimum radius. The approximation is disabled by default, i.e. with a
+   * tolerance of 0.
+   */
+
+  namespace Impl
+  {
+    /**
+     * @brief Square of the near-field radius of the far-field approximation
+     *
+     * @param[in] errorBound Bound of the relative error of the far-field approximation as a
+     * function of the distance in cells, decreasing for distances of at least one cell
+     * @param[in] GridSize Grid size (length of each cell)
+     * @param[in] FarFieldTolerance Tolerance of the relative error, 0 disables the approximation
+     * @param[in] NearFieldRadius Minimum near-field radius in cells
+     *
+     * @return Square of the near-field radius, infinity if the approximation is disabled
+     */
+    template <typename ErrorBound>
+    double FarFieldRadius2(const ErrorBound& errorBound, const double GridSize,
+        const double FarFieldTolerance, const double NearFieldRadius)
+    {
+      if (FarFieldTolerance <= 0.0) return std::numeric_limits<double>::infinity();
+
+      // Bisection for the smallest distance with errorBound(distance) <= FarFieldTolerance
+      double lower = 1.0;
+      double upper = 2.0;
+      while (errorBound(upper) > FarFieldTolerance) upper *= 2;
+      for (int i = 0; i < 60; ++i)
+      {
+        const double middle = (lower + upper) / 2;
+        (errorBound(middle) > FarFieldTolerance ? lower : upper) = middle;
+      }
+
+      const double radius = (upper > NearFieldRadius ? upper : NearFieldRadius) * GridSize;
+      return radius * radius;
+    }
+
+    /**
+     * @brief Split a positive normal number into x = 2^k m with sqrt(2)/2 < m <= sqrt(2)
+     *
+     * @param[in] x Number to split
+     * @param[out] k Exponent
+     *
+     * @return m
+     */
+    KOKKOS_INLINE_FUNCTION double SplitExponent(const double x, double& k)
+    {
+      std::uint64_t bits;
+      memcpy(&bits, &x, sizeof(double));
+      int exponent = static_cast<int>(bits >> 52) - 1023;
+      bits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+      double m;
+      memcpy(&m, &bits, sizeof(double));
+      if (m > M_SQRT2)
+      {
+        m *= 0.5;
+        ++exponent;
+      }
+      k = exponent;
+      return m;
+    }
+
+    /**
+     * @brief Natural logarithm of a positive normal number, for a double or a SIMD vector
+     *
+     * The math functions of Kokkos evaluate a SIMD vector lane by lane with the scalar function.
+     * This is the algorithm of the logarithm of fdlibm (accurate to 1 ulp), which only needs
+     * arithmetic besides the splitting of the exponent, i.e. it is vectorized for a SIMD vector. It
+     * is also used for a double, such that the entries of a matrix do not depend on whether they
+     * are evaluated as a vector.
+     */
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T Log(const T x)
+    {
+      constexpr double ln2Hi = 6.93147180369123816490e-01;
+      constexpr double ln2Lo = 1.90821492927058770002e-10;
+      constexpr double Lg1 = 6.666666666666735130e-01;
+      constexpr double Lg2 = 3.999999999940941908e-01;
+      constexpr double Lg3 = 2.857142874366239149e-01;
+      constexpr double Lg4 = 2.222219843214978396e-01;
+      constexpr double Lg5 = 1.818357216161805012e-01;
+      constexpr double Lg6 = 1.531383769920937332e-01;
+      constexpr double Lg7 = 1.479819860511658591e-01;
+
+      T k, m;
+      if constexpr (std::is_same_v<T, double>)
+      {
+        m = SplitExponent(x, k);
+      }
+      else
+      {
+        double kLanes[T::size()], mLanes[T::size()];
+        for (std::size_t lane = 0; lane < T::size(); ++lane)
+          mLanes[lane] = SplitExponent(x[lane], kLanes[lane]);
+        k = T([&](const std::size_t lane) { return kLanes[lane]; });
+        m = T([&](const std::size_t lane) { return mLanes[lane]; });
+      }
+
+      // log(m) = log(1 + f) = 2 atanh(s) with s = f / (2 + f), approximated by
+      // f - f^2/2 + s (f^2/2 + R(s^2))
+      const T f = m - 1.0;
+      const T s = f / (2.0 + f);
+      const T z = s * s;
+      const T w = z * z;
+      const T R = z * (Lg1 + w * (Lg3 + w * (Lg5 + w * Lg7))) + w * (Lg2 + w * (Lg4 + w * Lg6));
+      const T hfsq = 0.5 * f * f;
+      return k * ln2Hi - ((hfsq - (s * (hfsq + R) + k * ln2Lo)) - f);
+    }
+
+    /**
+     * @brief Arcsine of a number in [0, 1], for a double or a SIMD vector, vectorized like Log()
+     * with the rational approximation of fdlibm on [0, 1/2]
+     */
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T Asin(const T x)
+    {
+      constexpr double pS0 = 1.66666666666666657415e-01;
+      constexpr double pS1 = -3.25565818622400915405e-01;
+      constexpr double pS2 = 2.01212532134862925881e-01;
+      constexpr double pS3 = -4.00555345006794114027e-02;
+      constexpr double pS4 = 7.91534994289814532176e-04;
+      constexpr double pS5 = 3.47933107596021167570e-05;
+      constexpr double qS1 = -2.40339491173441421878e+00;
+      constexpr double qS2 = 2.02094576023350569471e+00;
+      constexpr double qS3 = -6.88283971605453293030e-01;
+      constexpr double qS4 = 7.70381505559019352791e-02;
+
+      // asin(x) = pi/2 - 2 asin(t) with t = sqrt((1 - x)/2) for x > 1/2, which does not occur for
+      // two distinct grid points
+      const auto reduce = [](const double xLane) {
+        return xLane > 0.5 ? Kokkos::sqrt((1.0 - xLane) / 2) : xLane;
+      };
+      T t;
+      if constexpr (std::is_same_v<T, double>)
+        t = reduce(x);
+      else
+        t = T([&](const std::size_t lane) { return reduce(x[lane]); });
+
+      // asin(t) = t + t R(t^2)
+      const T z = t * t;
+      const T p = z * (pS0 + z * (pS1 + z * (pS2 + z * (pS3 + z * (pS4 + z * pS5)))));
+      const T q = 1.0 + z * (qS1 + z * (qS2 + z * (qS3 + z * qS4)));
+      const T asinT = t + t * (p / q);
+
+      const auto expand = [](const double xLane, const double asinLane) {
+        return xLane > 0.5 ? M_PI_2 - 2 * asinLane : asinLane;
+      };
+      if constexpr (std::is_same_v<T, double>)
+        return expand(x, asinT);
+      else
+        return T([&](const std::size_t lane) { return expand(x[lane], asinT[lane]); });
+    }
+
+    /**
+     * @brief Evaluate the exact Green function within the near-field radius and its far-field
+     * approximation beyond it. For a SIMD vector, each of them is only evaluated if at least one
+     * lane needs it.
+     */
+    template <typename GreenFunction, typename T>
+    KOKKOS_INLINE_FUNCTION T EvaluateNearOrFarField(
+        const GreenFunction& g, const T dx, const T dy, const double farFieldRadius2)
+    {
+      if constexpr (std::is_same_v<T, double>)
+      {
+        return (dx * dx + dy * dy > farFieldRadius2) ? g.EvaluateFarField(dx, dy)
+                                                     : g.EvaluateExact(dx, dy);
+      }
+      else
+      {
+        const T r2 = dx * dx + dy * dy;
+        bool anyNear = false;
+        bool anyFar = false;
+        for (std::size_t lane = 0; lane < T::size(); ++lane)
+        {
+          const bool far = r2[lane] > farFieldRadius2;
+          anyNear = anyNear || !far;
+          anyFar = anyFar || far;
+        }
+        if (!anyFar) return g.EvaluateExact(dx, dy);
+        if (!anyNear) return g.EvaluateFarField(dx, dy);
+
+        const T exact = g.EvaluateExact(dx, dy);
+        const T farField = g.EvaluateFarField(dx, dy);
+        return T([&](const std::size_t lane) {
+          return r2[lane] > farFieldRadius2 ? farField[lane] : exact[lane];
+        });
+      }
+    }
+  }  // namespace Impl
+
+  /**
+   * @brief Green function based on a uniform pressure over a cell, see Pohrt and Li (2014)
+   * https://doi.org/10.1134/S1029959914040109
+   */
+  class PressureGreenFunction
+  {
+   public:
+    static constexpr bool pressure = true;
+    static constexpr bool symmetric = false;
+    static constexpr const char* name = "pressure Green function";
+
+    /**
+     * @param[in] GridSize Grid size (length of each cell)
+     * @param[in] CompositeYoungs The composite Young's modulus
+     * @param[in] FarFieldTolerance Tolerance of the relative error of the far-field
+     * approximation, 0 disables it
+     * @param[in] NearFieldRadius Minimum distance in cells up to which the exact Green function is
+     * used
+     */
+    PressureGreenFunction(const double GridSize, const double CompositeYoungs,
+        const double FarFieldTolerance = 0.0, const double NearFieldRadius = 0.0)
+        : gridSize_(GridSize),
+          coeff_(1.0 / (M_PI * CompositeYoungs)),
+          farFieldRadius2_(Impl::FarFieldRadius2(
+              FarFieldErrorBound, GridSize, FarFieldTolerance, NearFieldRadius))
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION double GridSize() const { return gridSize_; }
+
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T Evaluate(const T dx, const T dy) const
+    {
+      return Impl::EvaluateNearOrFarField(*this, dx, dy, farFieldRadius2_);
+    }
+
+    KOKKOS_INLINE_FUNCTION double Self() const { return EvaluateExact(0.0, 0.0); }
+
+    KOKKOS_INLINE_FUNCTION double operator()(const double dx, const double dy) const
+    {
+      return Evaluate(dx, dy);
+    }
+
+    // Please look at equation 12 of the paper mentioned above.
+    // ((1-nu)/2*pi*G) from the equation is replaced with (1/pi*CompositeYoungs) here.
+    // The paper uses a decoupled shear modulus and Poisson's ratio. We use a composite Young's
+    // modulus here, instead.
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T EvaluateExact(const T dx, const T dy) const
+    {
+      // Kokkos provides the overload of sqrt for SIMD vectors, see Impl::Log() for the logarithm
+      using Impl::Log;
+      using Kokkos::sqrt;
+
+      const double frac_GridSize_2 = gridSize_ / 2;
+
+      const T k = dx + frac_GridSize_2;
+      const T l = k - gridSize_;
+      const T m = dy + frac_GridSize_2;
+      const T n = m - gridSize_;
+
+      return coeff_ * (k * Log((sqrt(k * k + m * m) + m) / (sqrt(k * k + n * n) + n)) +
+                          l * Log((sqrt(l * l + n * n) + n) / (sqrt(l * l + m * m) + m)) +
+                          m * Log((sqrt(m * m + k * k) + k) / (sqrt(m * m + l * l) + l)) +
+                          n * Log((sqrt(n * n + l * l) + l) / (sqrt(n * n + k * k) + k)));
+    }
+
+    // Multipole expansion of the integral of 1/|r - r'| over the cell up to the hexadecapole:
+    // h^2/r * (1 + h^2/(24 r^2) + h^4 (63 - 70 s)/(1920 r^4)) with s = (dx^4 + dy^4)/r^4
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T EvaluateFarField(const T dx, const T dy) const
+    {
+      using Kokkos::sqrt;
+
+      const double h2 = gridSize_ * gridSize_;
+      const T dx2 = dx * dx;
+      const T dy2 = dy * dy;
+      const T r2 = dx2 + dy2;
+      const T q = h2 / r2;
+      const T s = (dx2 * dx2 + dy2 * dy2) / (r2 * r2);
+
+      return coeff_ * h2 / sqrt(r2) * (1.0 + q * (1.0 / 24 + q * (63.0 - 70.0 * s) / 1920));
+    }
+
+    /**
+     * @brief Bound of the relative error of EvaluateFarField() at a distance of rho cells. The
+     * first omitted term of the expansion is bounded by the sixth moment of the cell, and the
+     * remaining ones by a geometric series in the half diagonal of the cell over the distance.
+     */
+    static double FarFieldErrorBound(const double rho)
+    {
+      return 0.0108 / pow(rho, 6) / (1.0 - 0.7072 / rho);
+    }
+
+   private:
+    double gridSize_;
+    // 1 / (pi * CompositeYoungs)
+    double coeff_;
+    // Square of the distance beyond which EvaluateFarField() is used
+    double farFieldRadius2_;
+  };
+
+  /**
+   * @brief Green function based on a point force
+   */
+  class PointForceGreenFunction
+  {
+   public:
+    static constexpr bool pressure = false;
+    static constexpr bool symmetric = true;
+    static constexpr const char* name = "point force Green function";
+
+    /**
+     * @param[in] GridSize Grid size (length of each cell)
+     * @param[in] CompositeYoungs The composite Young's modulus
+     * @param[in] FarFieldTolerance Tolerance of the relative error of the far-field
+     * approximation, 0 disables it
+     * @param[in] NearFieldRadius Minimum distance in cells up to which the exact Green function is
+     * used
+     */
+    PointForceGreenFunction(const double GridSize, const double CompositeYoungs,
+        const double FarFieldTolerance = 0.0, const double NearFieldRadius = 0.0)
+        : gridSize_(GridSize),
+          C_(1 / (CompositeYoungs * M_PI * (GridSize / 2))),
+          farFieldRadius2_(Impl::FarFieldRadius2(
+              FarFieldErrorBound, GridSize, FarFieldTolerance, NearFieldRadius))
+    {
+    }
+
+    KOKKOS_INLINE_FUNCTION double GridSize() const { return gridSize_; }
+
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T Evaluate(const T dx, const T dy) const
+    {
+      return Impl::EvaluateNearOrFarField(*this, dx, dy, farFieldRadius2_);
+    }
+
+    KOKKOS_INLINE_FUNCTION double Self() const { return C_; }
+
+    KOKKOS_INLINE_FUNCTION double operator()(const double dx, const double dy) const
+    {
+      if (dx == 0.0 && dy == 0.0) return Self();
+      return Evaluate(dx, dy);
+    }
+
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T EvaluateExact(const T dx, const T dy) const
+    {
+      // Kokkos provides the overload of sqrt for SIMD vectors
+      using Kokkos::sqrt;
+
+      const T r = sqrt(dx * dx + dy * dy);
+      return C_ * Impl::Asin(gridSize_ / 2 / r);
+    }
+
+    // Taylor series asin(z) = z (1 + z^2/6 + 3 z^4/40) with z = h/(2 r)
+    template <typename T>
+    KOKKOS_INLINE_FUNCTION T EvaluateFarField(const T dx, const T dy) const
+    {
+      using Kokkos::sqrt;
+
+      const T z = gridSize_ / 2 / sqrt(dx * dx + dy * dy);
+      const T z2 = z * z;
+      return C_ * z * (1.0 + z2 * (1.0 / 6 + z2 * (3.0 / 40)));
+    }
+
+    /**
+     * @brief Bound of the relative error of EvaluateFarField() at a distance of rho cells. The
+     * omitted coefficients of the Taylor series are at most 5/112.
+     */
+    static double FarFieldErrorBound(const double rho)
+    {
+      const double z2 = 1.0 / (4 * rho * rho);
+      return 5.0 / 112 * z2 * z2 * z2 / (1.0 - z2);
+    }
+
+   private:
+    double gridSize_;
+    // 1 / (CompositeYoungs * pi * GridSize / 2), which is also the influence coefficient of a point
+    // on itself
+    double C_;
+    // Square of the distance beyond which EvaluateFarField() is used
+    double farFieldRadius2_;
+  };
+
+  /**
+   * @brief Tag type which passes a Green function policy to a generic lambda
+   */
+  template <typename GreenFunction>
+  struct GreenFunctionTag
+  {
+    using type = GreenFunction;
+  };
+
+  /**
+   * @brief Call function with the tag of the Green function selected at runtime, i.e.
+   * function(GreenFunctionTag<PressureGreenFunction>()) or
+   * function(GreenFunctionTag<PointForceGreenFunction>())
+   *
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   */
+  template <typename Function>
+  decltype(auto) DispatchGreenFunction(const bool PressureGreenFunFlag, Function&& function)
+  {
+    if (PressureGreenFunFlag) return function(GreenFunctionTag<PressureGreenFunction>());
+    return function(GreenFunctionTag<PointForceGreenFunction>());
+  }
+}  // namespace MIRCO
+
+#endif  // SRC_GREENFUNCTIONS_H_
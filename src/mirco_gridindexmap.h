@@ -0,0 +1,71 @@
+#ifndef SRC_GRIDINDEXMAP_H_
+#define SRC_GRIDINDEXMAP_H_
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  /**
+   * @brief Position of every grid point of a set of grid points, e.g. of the points predicted to
+   * be in contact, which is looked up in kernels
+   *
+   * The grid indices are sorted along with their positions, and a lookup is a binary search. It
+   * needs memory for the points of the set instead of for all N^2 grid points, which would exceed
+   * the set by far for large grids.
+   */
+  class GridIndexMap
+  {
+   public:
+    /**
+     * @brief Sort the grid indices of a set of grid points
+     *
+     * @param[in] set Distinct grid indices
+     * @param[in] label Label of the views
+     */
+    explicit GridIndexMap(
+        const ViewVectorGridIndex_d set, const std::string& label = "GridIndexMap")
+    {
+      const int n = set.extent(0);
+      const auto set_h = Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(), set);
+      ViewVectorInt_h positions_h(label + "; positions_h", n);
+      std::iota(positions_h.data(), positions_h.data() + n, 0);
+      std::sort(positions_h.data(), positions_h.data() + n,
+          [&](const int k, const int l) { return set_h(k) < set_h(l); });
+      ViewVectorGridIndex_h keys_h(label + "; keys_h", n);
+      for (int s = 0; s < n; ++s) keys_h(s) = set_h(positions_h(s));
+
+      keys_ = Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(), keys_h);
+      positions_ = Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(), positions_h);
+    }
+
+    /**
+     * @brief Position of the grid point a in the set, -1 if it is not in the set
+     */
+    KOKKOS_INLINE_FUNCTION int operator()(const GridIndex_t a) const
+    {
+      int first = 0;
+      int last = keys_.extent(0);
+      while (first < last)
+      {
+        const int middle = first + (last - first) / 2;
+        if (keys_(middle) < a)
+          first = middle + 1;
+        else
+          last = middle;
+      }
+      return (first < static_cast<int>(keys_.extent(0)) && keys_(first) == a) ? positions_(first)
+                                                                                : -1;
+    }
+
+   private:
+    // Sorted grid indices and their positions in the set
+    ViewVectorGridIndex_d keys_;
+    ViewVectorInt_d positions_;
+  };
+}  // namespace MIRCO
+
+#endif  // SRC_GRIDINDEXMAP_H_
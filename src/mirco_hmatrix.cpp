@@ -0,0 +1,583 @@
+#include "mirco_hmatrix.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mirco_greenfunctions.h"
+#include "mirco_timer.h"
+
+namespace
+{
+  using namespace MIRCO;
+
+  // Node of the cluster tree: the points [begin, end) of the cluster tree ordering, their bounding
+  // box and the two children (-1 for a leaf)
+  struct Cluster
+  {
+    int begin, end;
+    double xmin, xmax, ymin, ymax;
+    int children[2] = {-1, -1};
+
+    bool IsLeaf() const { return children[0] < 0; }
+    double Diameter() const { return std::hypot(xmax - xmin, ymax - ymin); }
+  };
+
+  double Distance(const Cluster& s, const Cluster& t)
+  {
+    const double dx = std::max({0.0, s.xmin - t.xmax, t.xmin - s.xmax});
+    const double dy = std::max({0.0, s.ymin - t.ymax, t.ymin - s.ymax});
+    return std::hypot(dx, dy);
+  }
+
+  // Block of two clusters; rank < 0 for a dense block
+  struct Block
+  {
+    int rowCluster, colCluster;
+    int rank = -1;
+    std::vector<double> U, V;
+  };
+
+  /**
+   * @brief Recursively bisect the bounding box of the points [begin, end) of order along its longer
+   * side at the median point
+   *
+   * @return Index of the cluster in clusters
+   */
+  int BuildClusterTree(std::vector<Cluster>& clusters, std::vector<int>& order,
+      const ViewVector_h x, const ViewVector_h y, const int begin, const int end,
+      const int LeafSize)
+  {
+    Cluster cluster{begin, end, x(order[begin]), x(order[begin]), y(order[begin]),
+        y(order[begin])};
+    for (int i = begin + 1; i < end; ++i)
+    {
+      cluster.xmin = std::min(cluster.xmin, x(order[i]));
+      cluster.xmax = std::max(cluster.xmax, x(order[i]));
+      cluster.ymin = std::min(cluster.ymin, y(order[i]));
+      cluster.ymax = std::max(cluster.ymax, y(order[i]));
+    }
+    const int index = clusters.size();
+    clusters.push_back(cluster);
+
+    if (end - begin > LeafSize)
+    {
+      const ViewVector_h coordinate =
+          (cluster.xmax - cluster.xmin >= cluster.ymax - cluster.ymin) ? x : y;
+      const int middle = (begin + end) / 2;
+      std::nth_element(order.begin() + begin, order.begin() + middle, order.begin() + end,
+          [&](const int a, const int b) { return coordinate(a) < coordinate(b); });
+
+      const int child0 = BuildClusterTree(clusters, order, x, y, begin, middle, LeafSize);
+      const int child1 = BuildClusterTree(clusters, order, x, y, middle, end, LeafSize);
+      clusters[index].children[0] = child0;
+      clusters[index].children[1] = child1;
+    }
+    return index;
+  }
+
+  /**
+   * @brief Partition the block of the clusters s and t into admissible blocks and dense blocks of
+   * leaves
+   */
+  void BuildBlocks(std::vector<Block>& blocks, const std::vector<Cluster>& clusters, const int s,
+      const int t, const double Admissibility)
+  {
+    const Cluster& cs = clusters[s];
+    const Cluster& ct = clusters[t];
+    const double distance = Distance(cs, ct);
+    if (distance > 0 && std::min(cs.Diameter(), ct.Diameter()) <= Admissibility * distance)
+    {
+      blocks.push_back({s, t, 0});
+    }
+    else if (cs.IsLeaf() || ct.IsLeaf())
+    {
+      blocks.push_back({s, t});
+    }
+    else
+    {
+      for (const int sChild : cs.children)
+        for (const int tChild : ct.children)
+          BuildBlocks(blocks, clusters, sChild, tChild, Admissibility);
+    }
+  }
+
+  /**
+   * @brief Adaptive cross approximation with partial pivoting (Bebendorf, 2000) of a rows x cols
+   * block, i.e. A ~ U V^T with the columns of U and V stored consecutively
+   *
+   * @param[in] entry Function which returns the entry A(i, j)
+   * @param[in] Tolerance Relative tolerance of the approximation in the Frobenius norm
+   * @param[in] maxRank Maximum rank
+   *
+   * @return Rank of the approximation, or -1 if the tolerance is not met with maxRank
+   */
+  template <typename Entry>
+  int CrossApproximation(const Entry& entry, const int rows, const int cols,
+      const double Tolerance, const int maxRank, std::vector<double>& U, std::vector<double>& V)
+  {
+    U.clear();
+    V.clear();
+    std::vector<bool> usedRow(rows, false);
+    std::vector<double> u(rows), v(cols);
+    // Estimate of the squared Frobenius norm of the approximation
+    double norm2 = 0.0;
+
+    int rank = 0;
+    int i = 0;
+    while (true)
+    {
+      usedRow[i] = true;
+
+      // Row i of the remainder
+      for (int j = 0; j < cols; ++j)
+      {
+        v[j] = entry(i, j);
+        for (int k = 0; k < rank; ++k) v[j] -= U[k * rows + i] * V[k * cols + j];
+      }
+      const int jmax =
+          std::max_element(v.begin(), v.end(), [](const double a, const double b) {
+            return std::abs(a) < std::abs(b);
+          }) -
+          v.begin();
+
+      if (v[jmax] != 0.0)
+      {
+        if (rank == maxRank) return -1;
+
+        const double pivot = v[jmax];
+        for (double& vj : v) vj /= pivot;
+
+        // Column jmax of the remainder
+        for (int r = 0; r < rows; ++r)
+        {
+          u[r] = entry(r, jmax);
+          for (int k = 0; k < rank; ++k) u[r] -= U[k * rows + r] * V[k * cols + jmax];
+        }
+
+        double uu = 0.0, vv = 0.0;
+        for (const double ur : u) uu += ur * ur;
+        for (const double vj : v) vv += vj * vj;
+        for (int k = 0; k < rank; ++k)
+        {
+          double uU = 0.0, vV = 0.0;
+          for (int r = 0; r < rows; ++r) uU += u[r] * U[k * rows + r];
+          for (int j = 0; j < cols; ++j) vV += v[j] * V[k * cols + j];
+          norm2 += 2 * uU * vV;
+        }
+        norm2 += uu * vv;
+
+        U.insert(U.end(), u.begin(), u.end());
+        V.insert(V.end(), v.begin(), v.end());
+        ++rank;
+
+        if (std::sqrt(uu * vv) <= Tolerance * std::sqrt(norm2)) return rank;
+      }
+
+      // Next pivot row: the largest entry of the last column among the unused rows
+      int next = -1;
+      for (int r = 0; r < rows; ++r)
+        if (!usedRow[r] && (next < 0 || (rank > 0 && std::abs(u[r]) > std::abs(u[next]))))
+          next = r;
+      if (next < 0) return rank;
+      i = next;
+    }
+  }
+}  // namespace
+
+namespace MIRCO
+{
+  template <typename GreenFunction>
+  HMatrix::HMatrix(const ViewVector_d xv0, const ViewVector_d yv0,
+      const GreenFunction& greenFunction, const double Tolerance, const int LeafSize,
+      const double Admissibility)
+      : n_(xv0.extent(0)), leafSize_(LeafSize), tolerance_(Tolerance)
+  {
+    const ScopedRegion region("HMatrix");
+    const std::string kokkosLabelPrefix = "HMatrix(); ";
+
+    const ViewVector_h x = Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(), xv0);
+    const ViewVector_h y = Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(), yv0);
+
+    // Cluster tree and blocks
+    std::vector<int> ordering(n_);
+    for (int a = 0; a < n_; ++a) ordering[a] = a;
+    std::vector<Cluster> clusters;
+    std::vector<Block> blocks;
+    if (n_ > 0)
+    {
+      BuildClusterTree(clusters, ordering, x, y, 0, n_, LeafSize);
+      BuildBlocks(blocks, clusters, 0, 0, Admissibility);
+    }
+
+    // Approximate the admissible blocks on the host; the ones which do not compress are stored
+    // densely
+    const GreenFunction g = greenFunction;
+    Kokkos::parallel_for(Kokkos::RangePolicy<ExecSpace_DefaultHost_t>(0, blocks.size()),
+        [&](const int b) {
+          Block& block = blocks[b];
+          if (block.rank < 0) return;
+
+          const Cluster& s = clusters[block.rowCluster];
+          const Cluster& t = clusters[block.colCluster];
+          const int rows = s.end - s.begin;
+          const int cols = t.end - t.begin;
+          const auto entry = [&](const int i, const int j) {
+            const int a = ordering[s.begin + i];
+            const int c = ordering[t.begin + j];
+            return g(x(a) - x(c), y(a) - y(c));
+          };
+          block.rank = CrossApproximation(
+              entry, rows, cols, Tolerance, rows * cols / (rows + cols), block.U, block.V);
+        });
+
+    // Layout of the blocks
+    const int numBlocks = blocks.size();
+    ViewVectorInt_h blockRow_h("blockRow_h", numBlocks);
+    ViewVectorInt_h blockCol_h("blockCol_h", numBlocks);
+    ViewVectorInt_h blockRows_h("blockRows_h", numBlocks);
+    ViewVectorInt_h blockCols_h("blockCols_h", numBlocks);
+    ViewVectorInt_h blockRank_h("blockRank_h", numBlocks);
+    ViewVectorSize_h blockOffset_h("blockOffset_h", numBlocks);
+    ViewVectorSize_h coefficientOffset_h("coefficientOffset_h", numBlocks);
+    std::vector<int> denseBlocks;
+    std::size_t numValues = 0;
+    std::size_t numCoefficients = 0;
+    for (int b = 0; b < numBlocks; ++b)
+    {
+      const Cluster& s = clusters[blocks[b].rowCluster];
+      const Cluster& t = clusters[blocks[b].colCluster];
+      blockRow_h(b) = s.begin;
+      blockCol_h(b) = t.begin;
+      blockRows_h(b) = s.end - s.begin;
+      blockCols_h(b) = t.end - t.begin;
+      blockRank_h(b) = blocks[b].rank;
+      blockOffset_h(b) = numValues;
+      coefficientOffset_h(b) = numCoefficients;
+      if (blocks[b].rank < 0)
+      {
+        denseBlocks.push_back(b);
+        numValues += static_cast<std::size_t>(blockRows_h(b)) * blockCols_h(b);
+      }
+      else
+      {
+        numValues += blocks[b].rank * (blockRows_h(b) + blockCols_h(b));
+        numCoefficients += blocks[b].rank;
+      }
+    }
+
+    // Leaves in the cluster tree ordering, with the offsets of their diagonal blocks
+    std::vector<int> leaves;
+    for (int c = 0; c < static_cast<int>(clusters.size()); ++c)
+      if (clusters[c].IsLeaf()) leaves.push_back(c);
+    std::sort(leaves.begin(), leaves.end(),
+        [&](const int c, const int d) { return clusters[c].begin < clusters[d].begin; });
+    const int numLeaves = leaves.size();
+    ViewVectorInt_h leafBegin_h("leafBegin_h", numLeaves + 1);
+    ViewVectorSize_h leafOffset_h("leafOffset_h", numLeaves);
+    for (int l = 0; l < numLeaves; ++l) leafBegin_h(l) = clusters[leaves[l]].begin;
+    leafBegin_h(numLeaves) = n_;
+    for (const int b : denseBlocks)
+      if (blocks[b].rowCluster == blocks[b].colCluster)
+      {
+        const int l = std::lower_bound(leaves.begin(), leaves.end(), blocks[b].rowCluster,
+                          [&](const int c, const int d) {
+                            return clusters[c].begin < clusters[d].begin;
+                          }) -
+                      leaves.begin();
+        leafOffset_h(l) = blockOffset_h(b);
+      }
+
+    // Low rank factors
+    ViewVector_h values_h("values_h", numValues);
+    for (int b = 0; b < numBlocks; ++b)
+    {
+      if (blocks[b].rank < 0) continue;
+      std::copy(blocks[b].U.begin(), blocks[b].U.end(), values_h.data() + blockOffset_h(b));
+      std::copy(blocks[b].V.begin(), blocks[b].V.end(),
+          values_h.data() + blockOffset_h(b) + blocks[b].U.size());
+    }
+
+    ViewVectorInt_h order_h("order_h", n_);
+    for (int i = 0; i < n_; ++i) order_h(i) = ordering[i];
+    ViewVectorInt_h denseBlocks_h("denseBlocks_h", denseBlocks.size());
+    for (std::size_t d = 0; d < denseBlocks.size(); ++d) denseBlocks_h(d) = denseBlocks[d];
+
+    const auto toDevice = [](const auto view_h) {
+      return Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(), view_h);
+    };
+    order_ = toDevice(order_h);
+    blockRow_ = toDevice(blockRow_h);
+    blockCol_ = toDevice(blockCol_h);
+    blockRows_ = toDevice(blockRows_h);
+    blockCols_ = toDevice(blockCols_h);
+    blockRank_ = toDevice(blockRank_h);
+    blockOffset_ = toDevice(blockOffset_h);
+    coefficientOffset_ = toDevice(coefficientOffset_h);
+    leafBegin_ = toDevice(leafBegin_h);
+    leafOffset_ = toDevice(leafOffset_h);
+    values_ = toDevice(values_h);
+    const ViewVectorInt_d denseBlocks_d = toDevice(denseBlocks_h);
+
+    position_ = ViewVectorInt_d(kokkosLabelPrefix + "position", n_);
+    coefficients_ = ViewVector_d(kokkosLabelPrefix + "coefficients", numCoefficients);
+    xOrdered_ = ViewVector_d(kokkosLabelPrefix + "xOrdered", n_);
+    yOrdered_ = ViewVector_d(kokkosLabelPrefix + "yOrdered", n_);
+
+    const ViewVectorInt_d order = order_;
+    const ViewVectorInt_d position = position_;
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "position", n_, KOKKOS_LAMBDA(const int i) { position(order(i)) = i; });
+
+    // Evaluate the dense blocks on the device
+    const ViewVectorInt_d blockRow = blockRow_;
+    const ViewVectorInt_d blockCol = blockCol_;
+    const ViewVectorInt_d blockRows = blockRows_;
+    const ViewVectorInt_d blockCols = blockCols_;
+    const ViewVectorSize_d blockOffset = blockOffset_;
+    const ViewVector_d values = values_;
+    using team_policy = Kokkos::TeamPolicy<ExecSpace_Default_t>;
+    Kokkos::parallel_for(kokkosLabelPrefix + "dense blocks",
+        team_policy(denseBlocks_d.extent(0), Kokkos::AUTO),
+        KOKKOS_LAMBDA(const team_policy::member_type& team) {
+          const int b = denseBlocks_d(team.league_rank());
+          const int row = blockRow(b);
+          const int col = blockCol(b);
+          const int cols = blockCols(b);
+          const std::size_t offset = blockOffset(b);
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, blockRows(b) * cols), [&](const int e) {
+                const int a = order(row + e / cols);
+                const int c = order(col + e % cols);
+                values(offset + e) = g(xv0(a) - xv0(c), yv0(a) - yv0(c));
+              });
+        });
+  }
+
+  void HMatrix::Apply(ViewVector_d y, const ViewVector_d x) const
+  {
+    const ScopedRegion region("HMatrix::Apply");
+    const std::string kokkosLabelPrefix = "HMatrix::Apply(); ";
+
+    // Note: KOKKOS_LAMBDA captures by value, i.e. the views have to be copied from the members
+    const ViewVectorInt_d order = order_;
+    const ViewVectorInt_d blockRow = blockRow_;
+    const ViewVectorInt_d blockCol = blockCol_;
+    const ViewVectorInt_d blockRows = blockRows_;
+    const ViewVectorInt_d blockCols = blockCols_;
+    const ViewVectorInt_d blockRank = blockRank_;
+    const ViewVectorSize_d blockOffset = blockOffset_;
+    const ViewVectorSize_d coefficientOffset = coefficientOffset_;
+    const ViewVector_d values = values_;
+    const ViewVector_d coefficients = coefficients_;
+    const ViewVector_d xOrdered = xOrdered_;
+    const ViewVector_d yOrdered = yOrdered_;
+
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "order", n_, KOKKOS_LAMBDA(const int i) {
+          xOrdered(i) = x(order(i));
+          yOrdered(i) = 0.0;
+        });
+
+    using team_policy = Kokkos::TeamPolicy<ExecSpace_Default_t>;
+    const int numBlocks = blockRank_.extent(0);
+
+    // V^T x of the low rank blocks
+    Kokkos::parallel_for(kokkosLabelPrefix + "V^T x", team_policy(numBlocks, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const team_policy::member_type& team) {
+          const int b = team.league_rank();
+          const int rank = blockRank(b);
+          if (rank < 0) return;
+
+          const int col = blockCol(b);
+          const int cols = blockCols(b);
+          const std::size_t V = blockOffset(b) + rank * blockRows(b);
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team, rank), [&](const int k) {
+            double sum = 0.0;
+            Kokkos::parallel_reduce(
+                Kokkos::ThreadVectorRange(team, cols),
+                [&](const int j, double& partialSum) {
+                  partialSum += values(V + k * cols + j) * xOrdered(col + j);
+                },
+                sum);
+            Kokkos::single(
+                Kokkos::PerThread(team), [&]() { coefficients(coefficientOffset(b) + k) = sum; });
+          });
+        });
+
+    // Products of the dense blocks, and U (V^T x) of the low rank blocks
+    Kokkos::parallel_for(kokkosLabelPrefix + "y", team_policy(numBlocks, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const team_policy::member_type& team) {
+          const int b = team.league_rank();
+          const int rank = blockRank(b);
+          const int row = blockRow(b);
+          const int rows = blockRows(b);
+          const int col = blockCol(b);
+          const int cols = blockCols(b);
+          const std::size_t offset = blockOffset(b);
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team, rows), [&](const int i) {
+            double sum = 0.0;
+            if (rank < 0)
+            {
+              Kokkos::parallel_reduce(
+                  Kokkos::ThreadVectorRange(team, cols),
+                  [&](const int j, double& partialSum) {
+                    partialSum += values(offset + i * cols + j) * xOrdered(col + j);
+                  },
+                  sum);
+            }
+            else
+            {
+              Kokkos::parallel_reduce(
+                  Kokkos::ThreadVectorRange(team, rank),
+                  [&](const int k, double& partialSum) {
+                    partialSum +=
+                        values(offset + k * rows + i) * coefficients(coefficientOffset(b) + k);
+                  },
+                  sum);
+            }
+            Kokkos::single(
+                Kokkos::PerThread(team), [&]() { Kokkos::atomic_add(&yOrdered(row + i), sum); });
+          });
+        });
+
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "reorder", n_,
+        KOKKOS_LAMBDA(const int i) { y(order(i)) = yOrdered(i); });
+  }
+
+  HMatrix::Preconditioner::Preconditioner(const HMatrix& matrix)
+      : leafSize_(matrix.leafSize_),
+        leafBegin_(matrix.leafBegin_),
+        leafOffset_(matrix.leafOffset_),
+        position_(matrix.position_),
+        values_(matrix.values_)
+  {
+    const std::string kokkosLabelPrefix = "HMatrix::Preconditioner(); ";
+    const int n = matrix.n_;
+    const int numLeaves = leafBegin_.extent(0) - 1;
+    leafCount_ = ViewVectorInt_d(kokkosLabelPrefix + "leafCount", numLeaves);
+    members_ = ViewVectorInt_d(kokkosLabelPrefix + "members", n);
+    positions_ = ViewVectorInt_d(kokkosLabelPrefix + "positions", n);
+    pivots_ = ViewVectorInt_d(kokkosLabelPrefix + "pivots", n);
+    // Every leaf has at most leafSize_ points, so its diagonal block fits into leafSize_ values
+    // per point
+    lu_ = ViewVector_d(kokkosLabelPrefix + "lu", static_cast<std::size_t>(n) * leafSize_);
+    inI_ = ViewVectorInt_d(kokkosLabelPrefix + "inI", n);
+    work_ = ViewVector_d(kokkosLabelPrefix + "work", n);
+  }
+
+  int HMatrix::Preconditioner::Update(const ViewVectorInt_d indices, const int size)
+  {
+    const ScopedRegion region("HMatrix::Preconditioner::Update");
+    const std::string kokkosLabelPrefix = "HMatrix::Preconditioner::Update(); ";
+
+    // Position in I of every point of the cluster tree ordering, -1 if it is not in I
+    const ViewVectorInt_d inI = inI_;
+    const ViewVectorInt_d position = position_;
+    Kokkos::deep_copy(inI, -1);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "inI", size, KOKKOS_LAMBDA(const int k) {
+          inI(position(indices(k))) = k;
+        });
+
+    const int leafSize = leafSize_;
+    const ViewVectorInt_d leafBegin = leafBegin_;
+    const ViewVectorSize_d leafOffset = leafOffset_;
+    const ViewVectorInt_d leafCount = leafCount_;
+    const ViewVectorInt_d members = members_;
+    const ViewVectorInt_d positions = positions_;
+    const ViewVectorInt_d pivots = pivots_;
+    const ViewVector_d lu = lu_;
+    const ViewVector_d values = values_;
+    int factorized = 0;
+    Kokkos::parallel_reduce(
+        kokkosLabelPrefix + "factorize", leafCount_.extent(0),
+        KOKKOS_LAMBDA(const int l, int& count) {
+          const int begin = leafBegin(l);
+          const int leafPoints = leafBegin(l + 1) - begin;
+
+          // Points of I in the leaf; their positions in I change with the order of I, but their
+          // diagonal block only if they are other points
+          int m = 0;
+          bool changed = false;
+          for (int q = begin; q < begin + leafPoints; ++q)
+          {
+            if (inI(q) < 0) continue;
+            changed = changed || m >= leafCount(l) || members(begin + m) != q;
+            members(begin + m) = q;
+            positions(begin + m) = inI(q);
+            ++m;
+          }
+          changed = changed || m != leafCount(l);
+          leafCount(l) = m;
+          if (!changed) return;
+          ++count;
+
+          // Diagonal block (row major)
+          double* A = &lu(static_cast<std::size_t>(begin) * leafSize);
+          for (int r = 0; r < m; ++r)
+          {
+            const int qr = members(begin + r) - begin;
+            for (int c = 0; c < m; ++c)
+            {
+              const int qc = members(begin + c) - begin;
+              A[r * m + c] = values(leafOffset(l) + qr * leafPoints + qc);
+            }
+          }
+
+          // LU factorization with partial pivoting
+          for (int c = 0; c < m; ++c)
+          {
+            int pivot = c;
+            for (int r = c + 1; r < m; ++r)
+              if (Kokkos::abs(A[r * m + c]) > Kokkos::abs(A[pivot * m + c])) pivot = r;
+            pivots(begin + c) = pivot;
+            if (pivot != c)
+              for (int cc = 0; cc < m; ++cc) Kokkos::kokkos_swap(A[c * m + cc], A[pivot * m + cc]);
+
+            for (int r = c + 1; r < m; ++r)
+            {
+              A[r * m + c] /= A[c * m + c];
+              for (int cc = c + 1; cc < m; ++cc) A[r * m + cc] -= A[r * m + c] * A[c * m + cc];
+            }
+          }
+        },
+        factorized);
+    return factorized;
+  }
+
+  void HMatrix::Preconditioner::Apply(ViewVector_d z, const ViewVector_d r) const
+  {
+    const int leafSize = leafSize_;
+    const ViewVectorInt_d leafBegin = leafBegin_;
+    const ViewVectorInt_d leafCount = leafCount_;
+    const ViewVectorInt_d positions = positions_;
+    const ViewVectorInt_d pivots = pivots_;
+    const ViewVector_d lu = lu_;
+    const ViewVector_d work = work_;
+    Kokkos::parallel_for(
+        "HMatrix::Preconditioner::Apply()", leafCount_.extent(0), KOKKOS_LAMBDA(const int l) {
+          const int begin = leafBegin(l);
+          const int m = leafCount(l);
+          const double* A = &lu(static_cast<std::size_t>(begin) * leafSize);
+          double* w = &work(begin);
+
+          for (int i = 0; i < m; ++i) w[i] = r(positions(begin + i));
+          for (int i = 0; i < m; ++i) Kokkos::kokkos_swap(w[i], w[pivots(begin + i)]);
+          for (int i = 0; i < m; ++i)
+            for (int j = 0; j < i; ++j) w[i] -= A[i * m + j] * w[j];
+          for (int i = m - 1; i >= 0; --i)
+          {
+            for (int j = i + 1; j < m; ++j) w[i] -= A[i * m + j] * w[j];
+            w[i] /= A[i * m + i];
+          }
+          for (int i = 0; i < m; ++i) z(positions(begin + i)) = w[i];
+        });
+  }
+
+  template HMatrix::HMatrix(const ViewVector_d, const ViewVector_d, const PressureGreenFunction&,
+      const double, const int, const double);
+  template HMatrix::HMatrix(const ViewVector_d, const ViewVector_d,
+      const PointForceGreenFunction&, const double, const int, const double);
+}  // namespace MIRCO
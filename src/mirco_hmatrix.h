@@ -0,0 +1,164 @@
+#ifndef SRC_HMATRIX_H_
+#define SRC_HMATRIX_H_
+
+#include <cstddef>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  /**
+   * @brief Hierarchical matrix (H-matrix) approximation of the influence coefficient matrix of the
+   * points predicted to be in contact.
+   *
+   * The points are ordered along a cluster tree, which recursively bisects their bounding box
+   * along its longer side down to clusters of at most LeafSize points. Blocks of two clusters which
+   * are far apart compared to their size (admissible blocks) are smooth and approximated by a low
+   * rank factorization U V^T computed with adaptive cross approximation (ACA), which only evaluates
+   * a few rows and columns of the block. All other blocks of two leaves are stored densely. This
+   * needs O(n log n) memory and operations per product instead of O(n^2) for the dense matrix.
+   *
+   * The matrix is not available entry by entry, so the nonlinear solver solves the systems of the
+   * active set iteratively with products of the whole matrix (see Apply()), preconditioned with
+   * the LU factorizations of the dense diagonal blocks (see Preconditioner).
+   */
+  class HMatrix
+  {
+   public:
+    /**
+     * @brief Build the cluster tree and approximate the blocks
+     *
+     * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+     * @param[in] xv0 x-coordinates of the points in contact in the previous iteration.
+     * @param[in] yv0 y-coordinates of the points in contact in the previous iteration.
+     * @param[in] greenFunction Green function of the grid
+     * @param[in] Tolerance Relative tolerance of the low rank approximations, which is also used
+     * for the iterative solver
+     * @param[in] LeafSize Maximum number of points of the leaves of the cluster tree
+     * @param[in] Admissibility A block is approximated if the smaller diameter of its clusters is
+     * at most Admissibility times their distance
+     */
+    template <typename GreenFunction>
+    HMatrix(const ViewVector_d xv0, const ViewVector_d yv0, const GreenFunction& greenFunction,
+        const double Tolerance, const int LeafSize = 32, const double Admissibility = 2.0);
+
+    /**
+     * @brief Number of rows (and columns) of the matrix
+     */
+    int Size() const { return n_; }
+
+    /**
+     * @brief Relative tolerance of the approximation
+     */
+    double Tolerance() const { return tolerance_; }
+
+    /**
+     * @brief Number of stored values (dense entries and entries of the low rank factors)
+     */
+    std::size_t StoredValues() const { return values_.extent(0); }
+
+    /**
+     * @brief Compute y = H x
+     *
+     * @param[out] y Vector of size Size()
+     * @param[in] x Vector of size Size()
+     */
+    void Apply(ViewVector_d y, const ViewVector_d x) const;
+
+    /**
+     * @brief Block diagonal approximate LU factorization of the principal submatrix H_I of a set
+     * of points I, i.e. the exact LU factorizations of the dense diagonal blocks of the leaves of
+     * the cluster tree restricted to I. The off-diagonal blocks (the interaction of neighbouring
+     * leaves and the far field) are dropped.
+     *
+     * It is built once per matrix and updated for every set I, which only factorizes the blocks
+     * of the leaves whose points in I changed.
+     */
+    class Preconditioner
+    {
+     public:
+      /**
+       * @brief Allocate the factorizations for sets of up to all points of the matrix, starting
+       * from an empty set I
+       *
+       * @param[in] matrix H-matrix
+       */
+      explicit Preconditioner(const HMatrix& matrix);
+
+      /**
+       * @brief Factorize the diagonal blocks for a new set of points I
+       *
+       * @param[in] indices The points I are indices(0), ..., indices(size - 1)
+       * @param[in] size Number of points in I
+       *
+       * @return Number of blocks which were factorized, i.e. whose points in I changed
+       */
+      int Update(const ViewVectorInt_d indices, const int size);
+
+      /**
+       * @brief Compute z = LU^{-1} r with vectors in the order of I
+       */
+      void Apply(ViewVector_d z, const ViewVector_d r) const;
+
+     private:
+      // Leaves of the cluster tree and their dense diagonal blocks (see HMatrix)
+      int leafSize_;
+      ViewVectorInt_d leafBegin_;
+      ViewVectorSize_d leafOffset_;
+      ViewVectorInt_d position_;
+      ViewVector_d values_;
+
+      // Number of points of I in every leaf, their positions in the cluster tree ordering and
+      // their positions in I, starting at leafBegin_
+      ViewVectorInt_d leafCount_;
+      ViewVectorInt_d members_;
+      ViewVectorInt_d positions_;
+
+      // LU factors of the restricted diagonal blocks (row major, starting at leafBegin_ *
+      // leafSize_) and their row interchanges (starting at leafBegin_)
+      ViewVector_d lu_;
+      ViewVectorInt_d pivots_;
+
+      // Work arrays of Update() and Apply()
+      ViewVectorInt_d inI_;
+      ViewVector_d work_;
+    };
+
+   private:
+    int n_;
+    int leafSize_;
+    double tolerance_;
+
+    // The i-th point of the cluster tree ordering is point order_(i), and point a is at position
+    // position_(a)
+    ViewVectorInt_d order_;
+    ViewVectorInt_d position_;
+
+    // Blocks: rows [blockRow_(b), blockRow_(b) + blockRows_(b)) and columns [blockCol_(b),
+    // blockCol_(b) + blockCols_(b)) in the cluster tree ordering. Dense blocks (blockRank_(b) < 0)
+    // are stored row major at values_(blockOffset_(b)), low rank blocks as U (column major)
+    // followed by V (column major).
+    ViewVectorInt_d blockRow_;
+    ViewVectorInt_d blockCol_;
+    ViewVectorInt_d blockRows_;
+    ViewVectorInt_d blockCols_;
+    ViewVectorInt_d blockRank_;
+    ViewVectorSize_d blockOffset_;
+    ViewVector_d values_;
+
+    // V^T x of the low rank blocks for Apply(), starting at coefficientOffset_(b)
+    ViewVectorSize_d coefficientOffset_;
+    ViewVector_d coefficients_;
+
+    // Leaves of the cluster tree: their first point, i.e. leaf l contains the points
+    // [leafBegin_(l), leafBegin_(l + 1)), and the offset of their dense diagonal block in values_
+    ViewVectorInt_d leafBegin_;
+    ViewVectorSize_d leafOffset_;
+
+    // Work arrays of Apply() in the cluster tree ordering
+    ViewVector_d xOrdered_;
+    ViewVector_d yOrdered_;
+  };
+}  // namespace MIRCO
+
+#endif  // SRC_HMATRIX_H_
@@ -0,0 +1,216 @@
+#include "mirco_influenceoperator.h"
+
+#include <math.h>
+
+#include "mirco_matrixsetup.h"
+
+namespace
+{
+  using namespace MIRCO;
+
+  using RangePolicy_t = Kokkos::RangePolicy<ExecSpace_Default_t>;
+  using MDRangePolicy2_t = Kokkos::MDRangePolicy<ExecSpace_Default_t, Kokkos::Rank<2>>;
+
+  // In-place iterative radix-2 FFT of all columns of the M x M matrix data, which are contiguous
+  // in memory. The inverse transform is not scaled.
+  void TransformColumns(const ExecSpace_Default_t& exec, ViewMatrixComplex_d data,
+      const ViewVectorComplex_d twiddles, const bool inverse)
+  {
+    const int M = data.extent(0);
+    Kokkos::parallel_for(
+        RangePolicy_t(exec, 0, M), KOKKOS_LAMBDA(const int col) {
+          // Bit reversal permutation
+          for (int k = 1, j = 0; k < M; ++k)
+          {
+            int bit = M >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (k < j)
+            {
+              const Kokkos::complex<double> tmp = data(k, col);
+              data(k, col) = data(j, col);
+              data(j, col) = tmp;
+            }
+          }
+
+          // Butterflies
+          for (int len = 2; len <= M; len <<= 1)
+          {
+            const int half = len / 2;
+            const int step = M / len;
+            for (int k = 0; k < half; ++k)
+            {
+              const Kokkos::complex<double> t = twiddles(k * step);
+              const Kokkos::complex<double> w(t.real(), inverse ? -t.imag() : t.imag());
+              for (int start = 0; start < M; start += len)
+              {
+                const Kokkos::complex<double> a = data(start + k, col);
+                const Kokkos::complex<double> b = data(start + k + half, col) * w;
+                data(start + k, col) = a + b;
+                data(start + k + half, col) = a - b;
+              }
+            }
+          }
+        });
+  }
+
+  void Transpose(const ExecSpace_Default_t& exec, ViewMatrixComplex_d data)
+  {
+    const int M = data.extent(0);
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec, {0, 0}, {M, M}),
+        KOKKOS_LAMBDA(const int a, const int b) {
+          if (b <= a) return;
+          const Kokkos::complex<double> tmp = data(a, b);
+          data(a, b) = data(b, a);
+          data(b, a) = tmp;
+        });
+  }
+
+  // 2D FFT built from transforms of contiguous columns. The result is stored transposed, which is
+  // irrelevant for the pointwise product in Fourier space as long as forward and inverse transforms
+  // are paired: the inverse transform of a transposed spectrum restores the original orientation.
+  void Transform2D(const ExecSpace_Default_t& exec, ViewMatrixComplex_d data,
+      const ViewVectorComplex_d twiddles, const bool inverse)
+  {
+    TransformColumns(exec, data, twiddles, inverse);
+    Transpose(exec, data);
+    TransformColumns(exec, data, twiddles, inverse);
+  }
+}  // namespace
+
+namespace MIRCO
+{
+  template <typename GreenFunction>
+  InfluenceOperator::InfluenceOperator(
+      const int N, const GreenFunction& greenFunction, const ExecSpace_Default_t& exec)
+      : InfluenceOperator(SetupInfluenceKernel(N, greenFunction, exec), exec)
+  {
+  }
+
+  InfluenceOperator::InfluenceOperator(const int N, const double GridSize,
+      const double CompositeYoungs, const bool PressureGreenFunFlag,
+      const ExecSpace_Default_t& exec)
+      : InfluenceOperator(
+            SetupInfluenceKernel(N, GridSize, CompositeYoungs, PressureGreenFunFlag, exec), exec)
+  {
+  }
+
+  InfluenceOperator::InfluenceOperator(const ViewMatrix_d kernel, const ExecSpace_Default_t& exec)
+      : N_(kernel.extent(0)), exec_(exec)
+  {
+    const int N = N_;
+    // Since the influence coefficients are even, the offsets N - 1 and -(N - 1) may share an entry
+    int M = 1;
+    while (M < 2 * N - 2) M <<= 1;
+    M_ = M;
+
+    twiddles_ = ViewVectorComplex_d(
+        Kokkos::view_alloc(exec, "InfluenceOperator; twiddles"), M / 2 > 0 ? M / 2 : 1);
+    kernelHat_ = ViewMatrix_d(Kokkos::view_alloc(exec, "InfluenceOperator; kernelHat"), M, M);
+    work_ = ViewMatrixComplex_d(Kokkos::view_alloc(exec, "InfluenceOperator; work"), M, M);
+
+    const auto twiddles = twiddles_;
+    Kokkos::parallel_for(
+        RangePolicy_t(exec, 0, M / 2), KOKKOS_LAMBDA(const int k) {
+          const double phi = -2.0 * M_PI * k / M;
+          twiddles(k) = Kokkos::complex<double>(cos(phi), sin(phi));
+        });
+
+    // Circulant embedding: offsets M - N < a < M correspond to the negative offsets a - M, the
+    // remaining entries between the positive and negative offsets (if any) are zero
+    const auto work = work_;
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec, {0, 0}, {M, M}),
+        KOKKOS_LAMBDA(const int a, const int b) {
+          const int da = a < N ? a : (a > M - N ? M - a : -1);
+          const int db = b < N ? b : (b > M - N ? M - b : -1);
+          work(a, b) = (da >= 0 && db >= 0) ? kernel(da, db) : 0.0;
+        });
+
+    Transform2D(exec, work, twiddles, false);
+
+    const auto kernelHat = kernelHat_;
+    const double scale = 1.0 / (static_cast<double>(M) * M);
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec, {0, 0}, {M, M}),
+        KOKKOS_LAMBDA(const int a, const int b) { kernelHat(a, b) = scale * work(a, b).real(); });
+  }
+
+  void InfluenceOperator::Apply(ViewVector_d u, const ViewVector_d p)
+  {
+    const int N = N_;
+    const int M = M_;
+    const auto work = work_;
+
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec_, {0, 0}, {M, M}), KOKKOS_LAMBDA(const int a, const int b) {
+          work(a, b) = (a < N && b < N) ? p(GridIndex(a, b, N)) : 0.0;
+        });
+
+    Convolve();
+
+    Kokkos::parallel_for(
+        GridRangePolicy_t(exec_, 0, static_cast<GridIndex_t>(N) * N),
+        KOKKOS_LAMBDA(const GridIndex_t a) { u(a) = work(a / N, a % N).real(); });
+  }
+
+  void InfluenceOperator::Apply(ViewMatrix_d u, const ViewMatrix_d p)
+  {
+    const int N = N_;
+    const int M = M_;
+    const auto work = work_;
+
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec_, {0, 0}, {M, M}), KOKKOS_LAMBDA(const int a, const int b) {
+          work(a, b) = (a < N && b < N) ? p(a, b) : 0.0;
+        });
+
+    Convolve();
+
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec_, {0, 0}, {N, N}),
+        KOKKOS_LAMBDA(const int a, const int b) { u(a, b) = work(a, b).real(); });
+  }
+
+  void InfluenceOperator::Convolve()
+  {
+    const int M = M_;
+    const auto kernelHat = kernelHat_;
+    const auto work = work_;
+
+    Transform2D(exec_, work, twiddles_, false);
+    Kokkos::parallel_for(
+        MDRangePolicy2_t(exec_, {0, 0}, {M, M}),
+        KOKKOS_LAMBDA(const int a, const int b) { work(a, b) *= kernelHat(a, b); });
+    Transform2D(exec_, work, twiddles_, true);
+  }
+
+  ViewMatrix_d ComputeDisplacementField(const ViewMatrix_d p_m, const double GridSize,
+      const double CompositeYoungs, const bool PressureGreenFunFlag)
+  {
+    const int N = p_m.extent(0);
+    ViewMatrix_d u_m("ComputeDisplacementField(); u_m", N, N);
+    InfluenceOperator H(N, GridSize, CompositeYoungs, PressureGreenFunFlag);
+    H.Apply(u_m, p_m);
+    return u_m;
+  }
+
+  template <typename GreenFunction>
+  ViewMatrix_d ComputeDisplacementField(const ViewMatrix_d p_m, const GreenFunction& greenFunction)
+  {
+    const int N = p_m.extent(0);
+    ViewMatrix_d u_m("ComputeDisplacementField(); u_m", N, N);
+    InfluenceOperator H(N, greenFunction);
+    H.Apply(u_m, p_m);
+    return u_m;
+  }
+
+  template InfluenceOperator::InfluenceOperator(
+      const int, const PressureGreenFunction&, const ExecSpace_Default_t&);
+  template InfluenceOperator::InfluenceOperator(
+      const int, const PointForceGreenFunction&, const ExecSpace_Default_t&);
+  template ViewMatrix_d ComputeDisplacementField(const ViewMatrix_d, const PressureGreenFunction&);
+  template ViewMatrix_d ComputeDisplacementField(
+      const ViewMatrix_d, const PointForceGreenFunction&);
+}  // namespace MIRCO
@@ -0,0 +1,117 @@
+#ifndef SRC_INFLUENCEOPERATOR_H_
+#define SRC_INFLUENCEOPERATOR_H_
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  /**
+   * @brief Matrix-free influence coefficient operator of a full N x N grid.
+   *
+   * The influence coefficient matrix H of a uniform grid is block Toeplitz with Toeplitz blocks,
+   * since its entries only depend on the offset between two grid points. Its product with a vector
+   * is therefore a discrete convolution, which is evaluated with fast Fourier transforms of a
+   * circulant embedding of size M x M (M is the smallest power of two with M >= 2 N - 2). This
+   * requires O(M^2) memory and O(M^2 log M) operations instead of O(N^4) for the dense matrix.
+   *
+   * Grid point (i, j) corresponds to the index a = i * N + j of the vectors.
+   */
+  class InfluenceOperator
+  {
+   public:
+    /**
+     * @brief Tabulate the influence coefficients and transform them to Fourier space
+     *
+     * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+     * @param[in] N Element count along one direction
+     * @param[in] greenFunction Green function of the grid
+     * @param[in] exec Execution space instance on which the setup and all products are run
+     */
+    template <typename GreenFunction>
+    InfluenceOperator(const int N, const GreenFunction& greenFunction,
+        const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+    /**
+     * @brief Tabulate the influence coefficients of the Green function selected at runtime and
+     * transform them to Fourier space
+     *
+     * @param[in] N Element count along one direction
+     * @param[in] GridSize Grid size (length of each cell)
+     * @param[in] CompositeYoungs The composite Young's modulus
+     * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+     * of point force
+     * @param[in] exec Execution space instance on which the setup and all products are run
+     */
+    InfluenceOperator(const int N, const double GridSize, const double CompositeYoungs,
+        const bool PressureGreenFunFlag, const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+    /**
+     * @brief Compute u = H p for the full grid
+     *
+     * @param[out] u Displacements of all N * N grid points
+     * @param[in] p Contact forces (or pressures) of all N * N grid points
+     */
+    void Apply(ViewVector_d u, const ViewVector_d p);
+
+    /**
+     * @brief Compute u = H p for the full grid, with the grid values stored as N x N matrices
+     *
+     * @param[out] u Displacements u(i, j) of all grid points
+     * @param[in] p Contact forces (or pressures) p(i, j) of all grid points
+     */
+    void Apply(ViewMatrix_d u, const ViewMatrix_d p);
+
+   private:
+    // Transform the tabulated influence coefficients (see SetupInfluenceKernel()) to Fourier space
+    InfluenceOperator(const ViewMatrix_d kernel, const ExecSpace_Default_t& exec);
+
+    // Convolve the grid values in the upper left N x N block of work_ with the influence
+    // coefficients
+    void Convolve();
+
+    int N_;
+    int M_;
+    ExecSpace_Default_t exec_;
+
+    // Twiddle factors exp(-2 pi i k / M) for 0 <= k < M / 2
+    ViewVectorComplex_d twiddles_;
+
+    // Fourier transform of the circulant embedding of the influence coefficients (stored
+    // transposed, like all spectra), scaled by 1 / M^2 for the inverse transform. It is real since
+    // the influence coefficients are even.
+    ViewMatrix_d kernelHat_;
+
+    // Work array for the transforms
+    ViewMatrixComplex_d work_;
+  };
+
+  /**
+   * @brief Compute the surface displacement field of the elastic half-space caused by the contact
+   * forces (or pressures) of all points of an N x N grid, i.e. u(i, j) = sum_{k, l} H(i, j, k, l)
+   * p(k, l). This is one zero-padded FFT convolution (see InfluenceOperator) instead of evaluating
+   * the Green function for every pair of points.
+   *
+   * @param[in] p_m Contact forces (or pressures) of all grid points, zero outside of the contact
+   * @param[in] GridSize Grid size (length of each cell)
+   * @param[in] CompositeYoungs The composite Young's modulus
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   *
+   * @return Displacements of all grid points
+   */
+  ViewMatrix_d ComputeDisplacementField(const ViewMatrix_d p_m, const double GridSize,
+      const double CompositeYoungs, const bool PressureGreenFunFlag);
+
+  /**
+   * @brief Compute the surface displacement field with the Green function given at compile time,
+   * see ComputeDisplacementField() above
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   * @param[in] greenFunction Green function of the grid
+   */
+  template <typename GreenFunction>
+  ViewMatrix_d ComputeDisplacementField(
+      const ViewMatrix_d p_m, const GreenFunction& greenFunction);
+}  // namespace MIRCO
+
+#endif  // SRC_INFLUENCEOPERATOR_H_
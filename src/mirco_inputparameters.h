@@ -5,6 +5,7 @@
 #include <string>
 
 #include "mirco_kokkostypes.h"
+#include "mirco_solveroptions.h"
 
 namespace MIRCO
 {
@@ -86,6 +87,7 @@ namespace MIRCO
     // own topology.
     ViewMatrix_d topology;
     std::optional<std::string> export_visualization_path;
+    SolverOptions solver_options;
   };
 }  // namespace MIRCO
 
@@ -60,4 +60,49 @@ MIRCO::InputParameters::InputParameters(const std::string& inputFileName)
         Utils::get_int(root, "MaxIteration"), Utils::get_bool(root, "WarmStartingFlag"),
         Utils::get_bool(root, "PressureGreenFunFlag"), exportVisualizationPath);
   }
+
+  solver_options.multilevel_levels = Utils::get_optional_int(root, "MultilevelLevels").value_or(0);
+  solver_options.visualization_double_precision =
+      Utils::get_optional_bool(root, "ExportVisualizationDoublePrecision").value_or(false);
+  solver_options.visualization_compression_level =
+      Utils::get_optional_int(root, "ExportVisualizationCompressionLevel").value_or(5);
+  if (solver_options.visualization_compression_level < 0 ||
+      solver_options.visualization_compression_level > 9)
+    throw std::runtime_error("ExportVisualizationCompressionLevel has to be between 0 and 9");
+  solver_options.visualization_async =
+      Utils::get_optional_bool(root, "ExportVisualizationAsync").value_or(false);
+  solver_options.print_timings = Utils::get_optional_bool(root, "PrintTimings").value_or(false);
+  if (const auto memoryBudgetGiB = Utils::get_optional_double(root, "MemoryBudgetGiB"))
+  {
+    if (memoryBudgetGiB.value() <= 0)
+      throw std::runtime_error("MemoryBudgetGiB has to be positive");
+    // Binary units, as in the memory reports (see FormatBytes())
+    solver_options.memory_budget =
+        static_cast<std::size_t>(memoryBudgetGiB.value() * (std::size_t(1) << 30));
+  }
+  solver_options.on_the_fly_matrix =
+      Utils::get_optional_bool(root, "OnTheFlyMatrix").value_or(false);
+  solver_options.space_filling_curve =
+      Utils::get_optional_bool(root, "SpaceFillingCurve").value_or(false);
+  solver_options.kernel_lookup = Utils::get_optional_bool(root, "KernelLookup").value_or(false);
+  solver_options.mixed_precision =
+      Utils::get_optional_bool(root, "MixedPrecision").value_or(false);
+  solver_options.contact_set_estimate =
+      Utils::get_optional_bool(root, "ContactSetEstimate").value_or(false);
+  solver_options.hmatrix_tolerance =
+      Utils::get_optional_double(root, "HMatrixTolerance").value_or(0.0);
+  if (solver_options.hmatrix_tolerance < 0)
+    throw std::runtime_error("HMatrixTolerance has to be non-negative");
+  if (solver_options.hmatrix_tolerance > 0 && solver_options.mixed_precision)
+    throw std::runtime_error(
+        "MixedPrecision cannot be combined with HMatrixTolerance, whose iterative solver does not "
+        "store H_I");
+  solver_options.far_field_tolerance =
+      Utils::get_optional_double(root, "FarFieldTolerance").value_or(0.0);
+  if (solver_options.far_field_tolerance < 0)
+    throw std::runtime_error("FarFieldTolerance has to be non-negative");
+  solver_options.near_field_radius =
+      Utils::get_optional_double(root, "NearFieldRadius").value_or(0.0);
+  if (solver_options.near_field_radius < 0)
+    throw std::runtime_error("NearFieldRadius has to be non-negative");
 }
@@ -2,6 +2,8 @@
 #define SRC_KOKKOSTYPES_H_
 
 #include <Kokkos_Core.hpp>
+#include <cstddef>
+#include <cstdint>
 
 // This file defines some commonly used Kokkos type aliases. More aliases, as well as Kokkos-related
 // macros, utilities, etc., can be added as needed
@@ -27,8 +29,38 @@ namespace MIRCO
   using ViewVector_d = Kokkos::View<double*, Kokkos::LayoutLeft, Device_Default_t>;
   using ViewMatrix_d = Kokkos::View<double**, Kokkos::LayoutLeft, Device_Default_t>;
 
+  // Single precision matrix of the mixed precision solver in MIRCO::nonlinearSolve()
+  using ViewMatrixFloat_d = Kokkos::View<float**, Kokkos::LayoutLeft, Device_Default_t>;
+
+  using ViewVectorComplex_d =
+      Kokkos::View<Kokkos::complex<double>*, Kokkos::LayoutLeft, Device_Default_t>;
+  using ViewMatrixComplex_d =
+      Kokkos::View<Kokkos::complex<double>**, Kokkos::LayoutLeft, Device_Default_t>;
+
   using ViewScalarInt_d = Kokkos::View<int, Kokkos::LayoutLeft, Device_Default_t>;
   using ViewVectorInt_d = Kokkos::View<int*, Kokkos::LayoutLeft, Device_Default_t>;
+
+  // Offsets into arrays which may have more than 2^31 entries
+  using ViewVectorSize_h = Kokkos::View<std::size_t*, Kokkos::LayoutLeft, Device_Host_t>;
+  using ViewVectorSize_d = Kokkos::View<std::size_t*, Kokkos::LayoutLeft, Device_Default_t>;
+
+  // Note: The grid point (i, j) of an N x N grid has the flat grid index a = i * N + j. There are
+  // more than 2^31 grid points for N > 46340, so grid indices (and loops over all grid points) are
+  // 64 bit. Positions in sets of grid points, e.g. in the set of points predicted to be in contact,
+  // remain int.
+  using GridIndex_t = std::int64_t;
+  using ViewVectorGridIndex_h = Kokkos::View<GridIndex_t*, Kokkos::LayoutLeft, Device_Host_t>;
+  using ViewVectorGridIndex_d = Kokkos::View<GridIndex_t*, Kokkos::LayoutLeft, Device_Default_t>;
+  using GridRangePolicy_t =
+      Kokkos::RangePolicy<ExecSpace_Default_t, Kokkos::IndexType<GridIndex_t>>;
+
+  /**
+   * @brief Flat grid index of the grid point (i, j) of an N x N grid
+   */
+  KOKKOS_INLINE_FUNCTION GridIndex_t GridIndex(const int i, const int j, const int N)
+  {
+    return static_cast<GridIndex_t>(i) * N + j;
+  }
 }  // namespace MIRCO
 
 #endif  // SRC_KOKKOSTYPES_H_
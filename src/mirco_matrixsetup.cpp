@@ -1,107 +1,240 @@
 #include "mirco_matrixsetup.h"
 
-#include <math.h>
+#include <string>
+#include <type_traits>
+
+#include "mirco_gridindexmap.h"
+#include "mirco_timer.h"
+
+namespace
+{
+  using namespace MIRCO;
+
+  // The explicitly vectorized kernels are used if the default execution space runs on the host. On
+  // GPUs, consecutive entries are computed by consecutive threads anyway.
+#if KOKKOS_VERSION >= 40000
+  constexpr bool useSimd = std::is_same_v<ExecSpace_Default_t, ExecSpace_DefaultHost_t>;
+#else
+  constexpr bool useSimd = false;
+#endif
+
+  // Distances between the points predicted to be in contact
+  struct PointDistances
+  {
+    ViewVector_d xv0, yv0;
+    KOKKOS_INLINE_FUNCTION double dx(const int i, const int j) const { return xv0(i) - xv0(j); }
+    KOKKOS_INLINE_FUNCTION double dy(const int i, const int j) const { return yv0(i) - yv0(j); }
+  };
+
+  // Offsets (a, b) between two grid points
+  struct GridOffsets
+  {
+    double GridSize;
+    KOKKOS_INLINE_FUNCTION double dx(const int a, const int) const { return a * GridSize; }
+    KOKKOS_INLINE_FUNCTION double dy(const int, const int b) const { return b * GridSize; }
+  };
+
+  /**
+   * @brief Fill the matrix A(i, j) = g(distances.dx(i, j), distances.dy(i, j)) with the Green
+   * function evaluated for SIMD vectors of consecutive rows, i.e. of entries which are contiguous
+   * in the LayoutLeft matrix. The lanes of two coinciding points get g.Self().
+   *
+   * If the matrix is symmetric, only the vectors of its lower half (including the diagonal) are
+   * evaluated, and their entries are also stored in the upper half.
+   */
+  template <typename GreenFunction, typename Distances>
+  void FillMatrixSimd(const std::string& label, const ExecSpace_Default_t& exec,
+      const ViewMatrix_d A, const GreenFunction g, const Distances distances,
+      const bool symmetric = false)
+  {
+#if KOKKOS_VERSION >= 40000
+    using simd_t = Kokkos::Experimental::native_simd<double>;
+    constexpr int width = simd_t::size();
+
+    const int rows = A.extent(0);
+    const int cols = A.extent(1);
+    const int blocks = (rows + width - 1) / width;
+    Kokkos::parallel_for(label,
+        Kokkos::MDRangePolicy<ExecSpace_Default_t, Kokkos::Rank<2>>(exec, {0, 0}, {blocks, cols}),
+        KOKKOS_LAMBDA(const int block, const int j) {
+          // The lanes beyond the last row repeat it
+          const int i0 = block * width;
+          if (symmetric && i0 + width <= j) return;
+          const simd_t dx([&](const std::size_t lane) {
+            return distances.dx(Kokkos::min(i0 + static_cast<int>(lane), rows - 1), j);
+          });
+          const simd_t dy([&](const std::size_t lane) {
+            return distances.dy(Kokkos::min(i0 + static_cast<int>(lane), rows - 1), j);
+          });
+          const simd_t values = g.Evaluate(dx, dy);
+
+          for (int lane = 0; lane < width && i0 + lane < rows; ++lane)
+          {
+            const int i = i0 + lane;
+            if (symmetric && i < j) continue;
+            A(i, j) = (dx[lane] == 0.0 && dy[lane] == 0.0) ? g.Self() : values[lane];
+            if (symmetric) A(j, i) = A(i, j);
+          }
+        });
+#endif
+  }
+}  // namespace
 
 namespace MIRCO
 {
-  ViewMatrix_d SetupMatrix(const ViewVector_d xv0, const ViewVector_d yv0, const double GridSize,
-      const double CompositeYoungs, const int systemsize, const bool PressureGreenFunFlag)
+  template <typename GreenFunction>
+  ViewMatrix_d SetupMatrix(const ViewVector_d xv0, const ViewVector_d yv0,
+      const GreenFunction& greenFunction, const int systemsize)
   {
-    constexpr double pi = M_PI;
-    const double frac_GridSize_2 = GridSize / 2;
+    const ScopedRegion region("SetupMatrix");
+    const std::string label = std::string("SetupMatrix(); ") + GreenFunction::name;
 
+    // Note: KOKKOS_LAMBDA will automatically capture const variables from the outer scope into
+    // device-space from host-space (but not non-const variables!)
+    const GreenFunction g = greenFunction;
     ViewMatrix_d H("SetupMatrix(); H", systemsize, systemsize);
-    if (PressureGreenFunFlag)
+    if constexpr (useSimd)
     {
-      // The pressure-based Green's function is based on the work of Pohrt and Li (2014)
-      // https://doi.org/10.1134/S1029959914040109
-      // Please look at equation 12 of the paper mentioned above.
-      // ((1-nu)/2*pi*G) from the equation is replaced with (1/pi*CompositeYoungs) here.
-      // The paper uses a decoupled shear modulus and Poisson's ratio. We use a composite Young's
-      // modulus here, instead.
-
-      // Note: KOKKOS_LAMBDA will automatically capture const variables from the outer scope into
-      // device-space from host-space (but not non-const variables!)
-      const double coeff = 1.0 / (pi * CompositeYoungs);
-      Kokkos::parallel_for(
-          Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {systemsize, systemsize}),
-          KOKKOS_LAMBDA(const int i, const int j) {
-            const double k = xv0(i) - xv0(j) + frac_GridSize_2;
-            const double l = k - GridSize;
-            const double m = yv0(i) - yv0(j) + frac_GridSize_2;
-            const double n = m - GridSize;
-
-            H(i, j) = coeff * (k * log((sqrt(k * k + m * m) + m) / (sqrt(k * k + n * n) + n)) +
-                                  l * log((sqrt(l * l + n * n) + n) / (sqrt(l * l + m * m) + m)) +
-                                  m * log((sqrt(m * m + k * k) + k) / (sqrt(m * m + l * l) + l)) +
-                                  n * log((sqrt(n * n + l * l) + l) / (sqrt(n * n + k * k) + k)));
-          });
+      FillMatrixSimd(label, ExecSpace_Default_t(), H, g, PointDistances{xv0, yv0},
+          GreenFunction::symmetric);
     }
-
-    else
+    else if constexpr (GreenFunction::symmetric)
     {
-      const double C = 1 / (CompositeYoungs * pi * frac_GridSize_2);
-
       // TODO: For potentially better performance, try using teams instead of MDRangePolicy
-      Kokkos::parallel_for(
+      Kokkos::parallel_for(label,
           Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {systemsize, systemsize}),
           KOKKOS_LAMBDA(const int i, const int j) {
-            if (j >= i) return;
-            const double tmp1 = xv0(j) - xv0(i);
-            const double tmp2 = yv0(j) - yv0(i);
-            const double r = sqrt(tmp1 * tmp1 + tmp2 * tmp2);
-            const double tmp3 = C * asin(frac_GridSize_2 / r);
+            if (j > i) return;
+            const double tmp3 = g(xv0(j) - xv0(i), yv0(j) - yv0(i));
             H(i, j) = tmp3;
             H(j, i) = tmp3;
           });
-
-      Kokkos::parallel_for(systemsize, KOKKOS_LAMBDA(const int i) { H(i, i) = C; });
     }
+    else
+    {
+      Kokkos::parallel_for(label,
+          Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {systemsize, systemsize}),
+          KOKKOS_LAMBDA(
+              const int i, const int j) { H(i, j) = g(xv0(i) - xv0(j), yv0(i) - yv0(j)); });
+    }
+    return H;
+  }
 
+  ViewMatrix_d SetupMatrix(const ViewVector_d xv0, const ViewVector_d yv0, const double GridSize,
+      const double CompositeYoungs, const int systemsize, const bool PressureGreenFunFlag)
+  {
+    return DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      return SetupMatrix(xv0, yv0, GreenFunction(GridSize, CompositeYoungs), systemsize);
+    });
+  }
+
+  template <typename GreenFunction>
+  ViewMatrix_d UpdateMatrix(const ViewMatrix_d previousH,
+      const ViewVectorGridIndex_d previousActiveSet, const ViewVectorGridIndex_d activeSet0,
+      const ViewVector_d xv0, const ViewVector_d yv0, const GreenFunction& greenFunction,
+      std::size_t& reusedEntries)
+  {
+    const ScopedRegion region("UpdateMatrix");
+    const std::string kokkosLabelPrefix = "UpdateMatrix(); ";
+    const int n0 = activeSet0.extent(0);
+
+    // Row of every grid point in the previous matrix, -1 if it was not predicted before
+    const GridIndexMap previousRow(previousActiveSet, kokkosLabelPrefix + "previousRow");
+
+    ViewVectorInt_d row(kokkosLabelPrefix + "row", n0);
+    int reusedPoints = 0;
+    Kokkos::parallel_reduce(
+        kokkosLabelPrefix + "row", n0,
+        KOKKOS_LAMBDA(const int i, int& count) {
+          row(i) = previousRow(activeSet0(i));
+          if (row(i) >= 0) ++count;
+        },
+        reusedPoints);
+    reusedEntries = static_cast<std::size_t>(reusedPoints) * reusedPoints;
+
+    const GreenFunction g = greenFunction;
+    ViewMatrix_d H(kokkosLabelPrefix + "H", n0, n0);
+    Kokkos::parallel_for(kokkosLabelPrefix + GreenFunction::name,
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {n0, n0}),
+        KOKKOS_LAMBDA(const int i, const int j) {
+          const int ri = row(i);
+          const int rj = row(j);
+          H(i, j) = (ri >= 0 && rj >= 0) ? previousH(ri, rj)
+                                         : g(xv0(i) - xv0(j), yv0(i) - yv0(j));
+        });
     return H;
   }
 
   double SetupMatrixOneEntry(const int ix, const int iy, const int jx, const int jy,
       const double GridSize, const double CompositeYoungs, const int N,
-      const bool PressureGreenFunFlag)
+      const bool PressureGreenFunFlag, const double FarFieldTolerance, const double NearFieldRadius)
   {
-    constexpr double pi = M_PI;
-    const double frac_GridSize_2 = GridSize / 2;
-
-    const double xi = ix * GridSize;
-    const double yi = iy * GridSize;
-    const double xj = jx * GridSize;
-    const double yj = jy * GridSize;
+    return DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      return SetupMatrixOneEntry(ix, iy, jx, jy,
+          GreenFunction(GridSize, CompositeYoungs, FarFieldTolerance, NearFieldRadius));
+    });
+  }
 
-    if (PressureGreenFunFlag)
+  template <typename GreenFunction>
+  ViewMatrix_d SetupInfluenceKernel(
+      const int N, const GreenFunction& greenFunction, const ExecSpace_Default_t& exec)
+  {
+    const GreenFunction g = greenFunction;
+    const std::string label = std::string("SetupInfluenceKernel(); ") + GreenFunction::name;
+    ViewMatrix_d kernel(Kokkos::view_alloc(exec, "SetupInfluenceKernel(); kernel"), N, N);
+    if constexpr (useSimd)
     {
-      const double k = xi - xj + frac_GridSize_2;
-      const double l = k - GridSize;
-      const double m = yi - yj + frac_GridSize_2;
-      const double n = m - GridSize;
-
-      return 1.0 / (pi * CompositeYoungs) *
-             (k * log((sqrt(k * k + m * m) + m) / (sqrt(k * k + n * n) + n)) +
-                 l * log((sqrt(l * l + n * n) + n) / (sqrt(l * l + m * m) + m)) +
-                 m * log((sqrt(m * m + k * k) + k) / (sqrt(m * m + l * l) + l)) +
-                 n * log((sqrt(n * n + l * l) + l) / (sqrt(n * n + k * k) + k)));
+      FillMatrixSimd(label, exec, kernel, g, GridOffsets{g.GridSize()});
     }
-
     else
     {
-      const double C = 1 / (CompositeYoungs * pi * frac_GridSize_2);
-
-      if (ix == jx && iy == jy)
-        return C;
-
-      else
-      {
-        const double tmp1 = xj - xi;
-        const double tmp2 = yj - yi;
-        const double r = sqrt(tmp1 * tmp1 + tmp2 * tmp2);
-        return C * asin(frac_GridSize_2 / r);
-      }
+      Kokkos::parallel_for(label,
+          Kokkos::MDRangePolicy<ExecSpace_Default_t, Kokkos::Rank<2>>(exec, {0, 0}, {N, N}),
+          KOKKOS_LAMBDA(const int a, const int b) {
+            // The grid size is the distance between two neighbouring points
+            kernel(a, b) = g(a * g.GridSize(), b * g.GridSize());
+          });
     }
+
+    return kernel;
+  }
+
+  ViewMatrix_d SetupInfluenceKernel(const int N, const double GridSize,
+      const double CompositeYoungs, const bool PressureGreenFunFlag,
+      const ExecSpace_Default_t& exec)
+  {
+    return DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      return SetupInfluenceKernel(N, GreenFunction(GridSize, CompositeYoungs), exec);
+    });
+  }
+
+  ViewMatrix_d SetupMatrix(const ViewVectorGridIndex_d activeSet0, const ViewMatrix_d kernel)
+  {
+    const ScopedRegion region("SetupMatrix");
+    const int n0 = activeSet0.extent(0);
+    const InfluenceKernelMatrix matrix(activeSet0, kernel);
+    ViewMatrix_d H("SetupMatrix(); H", n0, n0);
+    Kokkos::parallel_for("SetupMatrix(); kernel lookup",
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {n0, n0}),
+        KOKKOS_LAMBDA(const int i, const int j) { H(i, j) = matrix(i, j); });
+    return H;
   }
 
+  template ViewMatrix_d SetupMatrix(
+      const ViewVector_d, const ViewVector_d, const PressureGreenFunction&, const int);
+  template ViewMatrix_d SetupMatrix(
+      const ViewVector_d, const ViewVector_d, const PointForceGreenFunction&, const int);
+  template ViewMatrix_d UpdateMatrix(const ViewMatrix_d, const ViewVectorGridIndex_d,
+      const ViewVectorGridIndex_d, const ViewVector_d, const ViewVector_d,
+      const PressureGreenFunction&, std::size_t&);
+  template ViewMatrix_d UpdateMatrix(const ViewMatrix_d, const ViewVectorGridIndex_d,
+      const ViewVectorGridIndex_d, const ViewVector_d, const ViewVector_d,
+      const PointForceGreenFunction&, std::size_t&);
+  template ViewMatrix_d SetupInfluenceKernel(
+      const int, const PressureGreenFunction&, const ExecSpace_Default_t&);
+  template ViewMatrix_d SetupInfluenceKernel(
+      const int, const PointForceGreenFunction&, const ExecSpace_Default_t&);
 }  // namespace MIRCO
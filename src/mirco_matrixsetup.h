@@ -1,6 +1,9 @@
 #ifndef SRC_MATRIXSETUP_H_
 #define SRC_MATRIXSETUP_H_
 
+#include <cstddef>
+
+#include "mirco_greenfunctions.h"
 #include "mirco_kokkostypes.h"
 
 namespace MIRCO
@@ -8,22 +11,118 @@ namespace MIRCO
   /**
    * @brief Create the influence coefficient matrix (Discrete version of Green's function)
    *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
    * @param[in] xv0 x-coordinates of the points in contact in the previous iteration.
    * @param[in] yv0 y-coordinates of the points in contact in the previous iteration.
+   * @param[in] greenFunction Green function of the grid
+   * @param[in] systemsize Number of nodes predicted to be in contact
+   *
+   * @return Influence coefficient matrix (Discrete version of Green Function) (usually denoted H)
+   */
+  template <typename GreenFunction>
+  ViewMatrix_d SetupMatrix(const ViewVector_d xv0, const ViewVector_d yv0,
+      const GreenFunction& greenFunction, const int systemsize);
+
+  /**
+   * @brief Create the influence coefficient matrix with the Green function selected at runtime,
+   * see SetupMatrix() above
+   *
    * @param[in] GridSize Grid size (length of each cell)
    * @param[in] CompositeYoungs The composite Young's modulus
-   * @param[in] systemsize Number of nodes predicted to be in contact
    * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
    * of point force
-   *
-   * @return Influence coefficient matrix (Discrete version of Green Function) (usually denoted H)
    */
   ViewMatrix_d SetupMatrix(const ViewVector_d xv0, const ViewVector_d yv0, const double GridSize,
       const double CompositeYoungs, const int systemsize, const bool PressureGreenFunFlag);
 
   /**
-   * @brief Compute one entry of the full influence coefficient matriix. Use when memory is too
-   * constrained to store the full matrix.
+   * @brief Create the influence coefficient matrix of the points predicted to be in contact from
+   * the one of a previous prediction. The entries of the points which were also predicted before
+   * are copied from the previous matrix, and only the rows and columns of the newly predicted
+   * points are computed. The result is identical to SetupMatrix().
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   * @param[in] previousH Influence coefficient matrix of the previous prediction
+   * @param[in] previousActiveSet Indices of the grid points of the previous prediction
+   * @param[in] activeSet0 Indices of the grid points predicted to be in contact
+   * @param[in] xv0 x-coordinates of the points in activeSet0
+   * @param[in] yv0 y-coordinates of the points in activeSet0
+   * @param[in] greenFunction Green function of the grid
+   * @param[out] reusedEntries Number of entries copied from previousH
+   *
+   * @return Influence coefficient matrix of the points in activeSet0
+   */
+  template <typename GreenFunction>
+  ViewMatrix_d UpdateMatrix(const ViewMatrix_d previousH,
+      const ViewVectorGridIndex_d previousActiveSet, const ViewVectorGridIndex_d activeSet0,
+      const ViewVector_d xv0, const ViewVector_d yv0, const GreenFunction& greenFunction,
+      std::size_t& reusedEntries);
+
+  /**
+   * @brief Influence coefficient matrix of the points predicted to be in contact, whose entries are
+   * computed whenever they are accessed instead of being stored. The entries are identical to the
+   * ones of SetupMatrix(), but only the coordinates of the points are kept, i.e. O(n) instead of
+   * O(n^2) memory. Every access evaluates the Green function, so this is slower than a stored
+   * matrix and meant for problems whose matrix does not fit into the memory.
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   */
+  template <typename GreenFunction>
+  class OnTheFlyMatrix
+  {
+   public:
+    /**
+     * @param[in] xv0 x-coordinates of the points in contact in the previous iteration.
+     * @param[in] yv0 y-coordinates of the points in contact in the previous iteration.
+     * @param[in] greenFunction Green function of the grid
+     */
+    OnTheFlyMatrix(
+        const ViewVector_d xv0, const ViewVector_d yv0, const GreenFunction& greenFunction)
+        : xv0_(xv0), yv0_(yv0), greenFunction_(greenFunction)
+    {
+    }
+
+    /**
+     * @brief Entry H(i, j) of the influence coefficient matrix
+     */
+    KOKKOS_INLINE_FUNCTION double operator()(const int i, const int j) const
+    {
+      return greenFunction_(xv0_(i) - xv0_(j), yv0_(i) - yv0_(j));
+    }
+
+   private:
+    ViewVector_d xv0_;
+    ViewVector_d yv0_;
+    GreenFunction greenFunction_;
+  };
+
+  /**
+   * @brief Compute one entry of the full influence coefficient matrix with a given Green function.
+   * Use when memory is too constrained to store the full matrix. The Green function should be
+   * constructed once for all entries, since its constructor determines the near-field radius of
+   * the far-field approximation by bisection.
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   * @param[in] ix x index of first point
+   * @param[in] iy y index of first point
+   * @param[in] jx x index of second point
+   * @param[in] jy y index of second point
+   * @param[in] greenFunction Green function of the grid
+   *
+   * @return Matrix entry of H
+   */
+  template <typename GreenFunction>
+  KOKKOS_INLINE_FUNCTION double SetupMatrixOneEntry(const int ix, const int iy, const int jx,
+      const int jy, const GreenFunction& greenFunction)
+  {
+    const double GridSize = greenFunction.GridSize();
+    return greenFunction(ix * GridSize - jx * GridSize, iy * GridSize - jy * GridSize);
+  }
+
+  /**
+   * @brief Compute one entry of the full influence coefficient matriix with the Green function
+   * selected at runtime, see SetupMatrixOneEntry() above. This constructs the Green function for
+   * every entry.
    *
    * @param[in] ix x index of first point
    * @param[in] iy y index of first point
@@ -34,12 +133,91 @@ namespace MIRCO
    * @param[in] N Element count along one direction
    * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
    * of point force
+   * @param[in] FarFieldTolerance Tolerance of the relative error of the far-field approximation
+   * of the Green function, 0 disables it
+   * @param[in] NearFieldRadius Minimum distance in cells up to which the exact Green function is
+   * used
    *
    * @return Matrix entry of H
    */
   double SetupMatrixOneEntry(const int ix, const int iy, const int jx, const int jy,
       const double GridSize, const double CompositeYoungs, const int N,
-      const bool PressureGreenFunFlag);
+      const bool PressureGreenFunFlag, const double FarFieldTolerance = 0.0,
+      const double NearFieldRadius = 0.0);
+
+  /**
+   * @brief Tabulate the influence coefficients of a uniform grid. The entries of the influence
+   * coefficient matrix only depend on the offset between two grid points, i.e. H(i, j) =
+   * kernel(|ix - jx|, |iy - jy|).
+   *
+   * @tparam GreenFunction PressureGreenFunction or PointForceGreenFunction
+   * @param[in] N Element count along one direction
+   * @param[in] greenFunction Green function of the grid
+   * @param[in] exec Execution space instance to run on
+   *
+   * @return Influence coefficients for all offsets 0 <= a, b < N between two grid points
+   */
+  template <typename GreenFunction>
+  ViewMatrix_d SetupInfluenceKernel(const int N, const GreenFunction& greenFunction,
+      const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+  /**
+   * @brief Tabulate the influence coefficients with the Green function selected at runtime, see
+   * SetupInfluenceKernel() above
+   *
+   * @param[in] GridSize Grid size (length of each cell)
+   * @param[in] CompositeYoungs The composite Young's modulus
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   */
+  ViewMatrix_d SetupInfluenceKernel(const int N, const double GridSize,
+      const double CompositeYoungs, const bool PressureGreenFunFlag,
+      const ExecSpace_Default_t& exec = ExecSpace_Default_t());
+
+  /**
+   * @brief Influence coefficient matrix of grid points, which only keeps their grid indices and
+   * looks its entries up in the influence kernel (see SetupInfluenceKernel()) by their offsets.
+   * This needs neither the coordinates of the points nor evaluations of the Green function, but
+   * O(N^2) memory for the kernel, which is independent of the number of points.
+   */
+  class InfluenceKernelMatrix
+  {
+   public:
+    /**
+     * @param[in] points Indices of the grid points
+     * @param[in] kernel Influence kernel of the grid
+     */
+    InfluenceKernelMatrix(const ViewVectorGridIndex_d points, const ViewMatrix_d kernel)
+        : points_(points), kernel_(kernel)
+    {
+    }
+
+    /**
+     * @brief Entry H(i, j) of the influence coefficient matrix
+     */
+    KOKKOS_INLINE_FUNCTION double operator()(const int i, const int j) const
+    {
+      const int N = kernel_.extent(0);
+      const GridIndex_t a = points_(i);
+      const GridIndex_t b = points_(j);
+      return kernel_(Kokkos::abs(a / N - b / N), Kokkos::abs(a % N - b % N));
+    }
+
+   private:
+    ViewVectorGridIndex_d points_;
+    ViewMatrix_d kernel_;
+  };
+
+  /**
+   * @brief Create the influence coefficient matrix of grid points with the entries of an
+   * InfluenceKernelMatrix, i.e. from their grid indices only
+   *
+   * @param[in] activeSet0 Indices of the grid points predicted to be in contact
+   * @param[in] kernel Influence kernel of the grid (see SetupInfluenceKernel())
+   *
+   * @return Influence coefficient matrix of the points in activeSet0
+   */
+  ViewMatrix_d SetupMatrix(const ViewVectorGridIndex_d activeSet0, const ViewMatrix_d kernel);
 }  // namespace MIRCO
 
 #endif  // SRC_MATRIXSETUP_H_
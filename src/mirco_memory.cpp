@@ -0,0 +1,122 @@
+#include "mirco_memory.h"
+
+#include <sys/resource.h>
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  std::size_t MemoryEstimate::Total() const
+  {
+    std::size_t total = 0;
+    for (const auto& part : parts) total += part.second;
+    return total;
+  }
+
+  MemoryEstimate EstimateSolverMemory(const int N, const int n0, const bool storeMatrix,
+      const bool mixedPrecision, const bool kernelLookup, const bool hierarchical)
+  {
+    const std::size_t N2 = static_cast<std::size_t>(N) * N;
+    const std::size_t n = n0;
+    constexpr std::size_t d = sizeof(double);
+    constexpr std::size_t i = sizeof(int);
+    constexpr std::size_t g = sizeof(GridIndex_t);
+
+    MemoryEstimate estimate;
+    // topology and meshgrid
+    estimate.parts.emplace_back("Topology", N2 * d + N * d);
+    // activeSet0, xv0, yv0, b0, the initial guess p0 and the result (activeSetf, pf); the
+    // coordinates xv0 and yv0 are replaced by the influence kernel with kernel lookup
+    if (kernelLookup)
+    {
+      estimate.parts.emplace_back("Predicted contact set", n * (2 * g + 3 * d));
+      estimate.parts.emplace_back("Influence kernel", N2 * d);
+    }
+    else
+    {
+      estimate.parts.emplace_back("Predicted contact set", n * (2 * g + 5 * d));
+    }
+    if (storeMatrix)
+      estimate.parts.emplace_back("Influence coefficient matrix H", n * n * d);
+    if (hierarchical)
+    {
+      estimate.parts.emplace_back("Nonlinear solver (without H_I)", n * (2 * d + 2 * i));
+    }
+    else
+    {
+      // H_I, w, activeInactiveSet, s_I and the pivots of the LU decomposition, the residual and
+      // correction of the iterative refinement in mixed precision, and the positions of the cached
+      // columns without a stored matrix
+      const std::size_t h = mixedPrecision ? sizeof(float) : d;
+      const std::size_t refinement = mixedPrecision ? n * (d + h) : 0;
+      const std::size_t cache = storeMatrix ? 0 : n * i;
+      estimate.parts.emplace_back("Nonlinear solver (including H_I)",
+          n * n * h + n * (2 * d + 2 * i) + refinement + cache);
+    }
+    return estimate;
+  }
+
+  MemoryEstimate EstimateExportMemory(const int N)
+  {
+    const std::size_t N2 = static_cast<std::size_t>(N) * N;
+    std::size_t M = 1;
+    while (M < 2 * static_cast<std::size_t>(N) - 2) M *= 2;
+    constexpr std::size_t d = sizeof(double);
+
+    MemoryEstimate estimate;
+    // p_m, u_m, deformedHalfSpace and the copies in the VTK arrays (in the worst case in double
+    // precision)
+    estimate.parts.emplace_back("Exported fields", N2 * (3 * d + 4 * d + 1));
+    // Influence coefficients, their spectrum, the complex work array and the twiddle factors
+    estimate.parts.emplace_back("Displacement field FFT", N2 * d + M * M * 3 * d + M * d);
+    return estimate;
+  }
+
+  void CheckMemoryBudget(
+      const MemoryEstimate& estimate, const std::size_t budget, const std::string& description)
+  {
+    if (estimate.Total() <= budget) return;
+
+    std::stringstream report;
+    report << "The estimated memory of " << description << " exceeds the memory budget:\n";
+    for (const auto& [name, bytes] : estimate.parts)
+      report << "\t" << std::left << std::setw(36) << name + ":" << FormatBytes(bytes) << "\n";
+    report << "\t" << std::left << std::setw(36) << "Total:" << FormatBytes(estimate.Total())
+           << "\n";
+    report << "\t" << std::left << std::setw(36) << "Budget:" << FormatBytes(budget) << "\n";
+    throw std::runtime_error(report.str());
+  }
+
+  std::size_t GetPeakResidentSetSize()
+  {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    // Bytes on macOS
+    return usage.ru_maxrss;
+#else
+    // Kilobytes on Linux
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+  }
+
+  std::string FormatBytes(const std::size_t bytes)
+  {
+    const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double value = bytes;
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4)
+    {
+      value /= 1024.0;
+      ++unit;
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(unit == 0 ? 0 : 2) << value << " " << units[unit];
+    return ss.str();
+  }
+}  // namespace MIRCO
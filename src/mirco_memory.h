@@ -0,0 +1,78 @@
+#ifndef SRC_MEMORY_H_
+#define SRC_MEMORY_H_
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace MIRCO
+{
+  /**
+   * @brief Estimated memory requirements of the largest allocations of a computation
+   */
+  struct MemoryEstimate
+  {
+    // Description and size [bytes] of every part
+    std::vector<std::pair<std::string, std::size_t>> parts;
+
+    // Sum of all parts [bytes]
+    std::size_t Total() const;
+  };
+
+  /**
+   * @brief Estimate the peak memory of one iteration of the contact solver, i.e. of the predicted
+   * contact set, the dense influence coefficient matrix H and the nonlinear solver. In the worst
+   * case, the compact matrix H_I of the nonlinear solver is as large as H.
+   *
+   * Without a stored matrix (see OnTheFlyMatrix), H_I is still factorized, and the columns of the
+   * active set are cached in the part of its worst-case memory which H_I does not need. A
+   * hierarchical matrix (see HMatrix) needs no H_I, since its active set systems are solved
+   * iteratively; its compressed size is only known after its construction and is not included.
+   *
+   * @param[in] N Element count along one direction
+   * @param[in] n0 Number of points predicted to be in contact
+   * @param[in] storeMatrix Whether the influence coefficient matrix H is stored
+   * @param[in] mixedPrecision Whether H_I is stored in single precision (see
+   * SolverOptions::mixed_precision)
+   * @param[in] kernelLookup Whether the influence coefficients are looked up in the influence
+   * kernel instead of being computed from the coordinates of the points (see
+   * SolverOptions::kernel_lookup)
+   * @param[in] hierarchical Whether the matrix is a hierarchical matrix (see
+   * SolverOptions::hmatrix_tolerance)
+   */
+  MemoryEstimate EstimateSolverMemory(const int N, const int n0, const bool storeMatrix = true,
+      const bool mixedPrecision = false, const bool kernelLookup = false,
+      const bool hierarchical = false);
+
+  /**
+   * @brief Estimate the peak memory of the visualization export, i.e. of the exported fields and
+   * the work arrays of the FFT-based computation of the displacement field
+   *
+   * @param[in] N Element count along one direction
+   */
+  MemoryEstimate EstimateExportMemory(const int N);
+
+  /**
+   * @brief Throw an exception with a report of the estimate if it exceeds the budget
+   *
+   * @param[in] estimate Estimated memory requirements
+   * @param[in] budget Memory budget [bytes]
+   * @param[in] description Description of the computation for the report
+   */
+  void CheckMemoryBudget(
+      const MemoryEstimate& estimate, const std::size_t budget, const std::string& description);
+
+  /**
+   * @brief Peak resident set size of the process [bytes], i.e. the high-water mark of the host
+   * memory. Returns 0 if it is not available on the platform.
+   */
+  std::size_t GetPeakResidentSetSize();
+
+  /**
+   * @brief Format a number of bytes with a binary unit, e.g. "1.50 GiB"
+   */
+  std::string FormatBytes(const std::size_t bytes);
+}  // namespace MIRCO
+
+#endif  // SRC_MEMORY_H_
@@ -0,0 +1,86 @@
+#include "mirco_multilevel.h"
+
+namespace MIRCO
+{
+  std::vector<ViewMatrix_d> CreateTopologyHierarchy(
+      const ViewMatrix_d topology, const int maxLevels)
+  {
+    std::vector<ViewMatrix_d> hierarchy;
+
+    ViewMatrix_d fine = topology;
+    for (int l = 0; l < maxLevels; ++l)
+    {
+      const int N_f = fine.extent(0);
+      if ((N_f - 1) % 2 != 0) break;
+      const int N_c = (N_f + 1) / 2;
+      if (N_c < 3) break;
+
+      ViewMatrix_d coarse("CreateTopologyHierarchy(); coarse", N_c, N_c);
+      Kokkos::parallel_for(
+          Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {N_c, N_c}),
+          KOKKOS_LAMBDA(const int i, const int j) { coarse(i, j) = fine(2 * i, 2 * j); });
+
+      hierarchy.push_back(coarse);
+      fine = coarse;
+    }
+
+    return hierarchy;
+  }
+
+  void ProlongateContactSet(ViewVectorGridIndex_d& activeSet_f, ViewVector_d& p_f,
+      const ViewVectorGridIndex_d activeSet_c, const ViewVector_d p_c, const int N_c,
+      const double scale)
+  {
+    const int N_f = 2 * N_c - 1;
+    const int nc = activeSet_c.extent(0);
+
+    // Scatter the compact coarse solution to the full coarse grid
+    ViewMatrix_d p_m("ProlongateContactSet(); p_m", N_c, N_c);
+    Kokkos::parallel_for(
+        nc, KOKKOS_LAMBDA(const int indA) {
+          const GridIndex_t a = activeSet_c(indA);
+          p_m(a / N_c, a % N_c) = p_c(indA);
+        });
+
+    // Bilinear interpolation; for even indices the coarse value is taken directly. A fine point is
+    // only predicted to be in contact if all the surrounding coarse points are in contact, since
+    // the nonlinear solver removes wrongly predicted points one at a time, which is considerably
+    // more expensive than adding missing points at the boundary of the contact patches.
+    ViewMatrix_d p_fm("ProlongateContactSet(); p_fm", N_f, N_f);
+    int n_f = 0;
+    Kokkos::parallel_reduce(
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {N_f, N_f}),
+        KOKKOS_LAMBDA(const int i, const int j, int& local_sum) {
+          const int i0 = i / 2;
+          const int i1 = (i + 1) / 2;
+          const int j0 = j / 2;
+          const int j1 = (j + 1) / 2;
+          const double p00 = p_m(i0, j0);
+          const double p01 = p_m(i0, j1);
+          const double p10 = p_m(i1, j0);
+          const double p11 = p_m(i1, j1);
+          const bool inContact = p00 > 0.0 && p01 > 0.0 && p10 > 0.0 && p11 > 0.0;
+          const double value = inContact ? 0.25 * scale * (p00 + p01 + p10 + p11) : 0.0;
+          p_fm(i, j) = value;
+          if (inContact) local_sum++;
+        },
+        n_f);
+
+    activeSet_f = ViewVectorGridIndex_d("ProlongateContactSet(); activeSet_f", n_f);
+    p_f = ViewVector_d("ProlongateContactSet(); p_f", n_f);
+
+    ViewScalarInt_d counter("ProlongateContactSet(); counter");
+    Kokkos::deep_copy(counter, 0);
+    Kokkos::parallel_for(GridRangePolicy_t(0, static_cast<GridIndex_t>(N_f) * N_f),
+        KOKKOS_LAMBDA(const GridIndex_t a) {
+          const double value = p_fm(a / N_f, a % N_f);
+          if (value > 0.0)
+          {
+            const int aa = Kokkos::atomic_fetch_add(&counter(), 1);
+            activeSet_f(aa) = a;
+            p_f(aa) = value;
+          }
+        });
+  }
+
+}  // namespace MIRCO
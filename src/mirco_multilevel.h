@@ -0,0 +1,45 @@
+#ifndef SRC_MULTILEVEL_H_
+#define SRC_MULTILEVEL_H_
+
+#include <vector>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  /**
+   * @brief Create a hierarchy of successively coarser topologies by injection, i.e. every second
+   * grid point of a level is kept on the next coarser level. For N = 2^k + 1 (e.g. topologies from
+   * the random midpoint generator) this gives the natural 2^(k-l) + 1 hierarchy.
+   *
+   * The coarsening stops early if N - 1 of a level is odd or if the next level would have fewer
+   * than 3 grid points in one direction.
+   *
+   * @param[in] topology Topology matrix containing heights
+   * @param[in] maxLevels Maximum number of coarse levels to create
+   *
+   * @return Coarse topologies, ordered from fine to coarse (the given topology is not included)
+   */
+  std::vector<ViewMatrix_d> CreateTopologyHierarchy(
+      const ViewMatrix_d topology, const int maxLevels);
+
+  /**
+   * @brief Prolongate a converged contact set and the corresponding contact forces from a coarse
+   * grid with N_c points in one direction to the next finer grid with N_f = 2 N_c - 1 points in one
+   * direction, using bilinear interpolation. A fine point is only predicted to be in contact if all
+   * the surrounding coarse points are in contact.
+   *
+   * @param[out] activeSet_f Points predicted to be in contact on the fine grid
+   * @param[out] p_f Contact forces at the points in activeSet_f
+   * @param[in] activeSet_c Points in contact on the coarse grid
+   * @param[in] p_c Contact forces at the points in activeSet_c
+   * @param[in] N_c Element count along one direction of the coarse grid
+   * @param[in] scale Factor applied to the interpolated values (e.g. the ratio of the cell areas if
+   * p_c contains point forces rather than pressures)
+   */
+  void ProlongateContactSet(ViewVectorGridIndex_d& activeSet_f, ViewVector_d& p_f,
+      const ViewVectorGridIndex_d activeSet_c, const ViewVector_d p_c, const int N_c,
+      const double scale);
+}  // namespace MIRCO
+
+#endif  // SRC_MULTILEVEL_H_
@@ -1,6 +1,21 @@
 #include "mirco_nonlinearsolver.h"
 
+#include <KokkosBlas3_trsm.hpp>
 #include <KokkosLapack_gesv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mirco_gridindexmap.h"
+#include "mirco_hmatrix.h"
+#include "mirco_matrixsetup.h"
+#include "mirco_timer.h"
 
 namespace
 {
@@ -23,17 +38,662 @@ namespace
       Kokkos::deep_copy(vj, tmp);
     }
   }
+
+  /**
+   * @brief Solve H_I s_I = b0_I for the active set of an H-matrix with restarted GMRES, right
+   * preconditioned with the block LU factorization of HMatrix::Preconditioner. The products with
+   * H_I are products of the whole H-matrix with s_I padded with zeros.
+   *
+   * @param[in,out] s Initial guess and solution s_I
+   * @param[in] matrix H-matrix of all predicted points
+   * @param[in,out] preconditioner Preconditioner of the matrix, which is updated for the active set
+   * @param[in] activeInactiveSet The active set are its first activeSetSize entries
+   * @param[in] b0 Indentation value of the half space at the predicted points of contact
+   */
+  void SolveActiveSetIteratively(ViewVector_d s, const HMatrix& matrix,
+      HMatrix::Preconditioner& preconditioner, const ViewVectorInt_d activeInactiveSet,
+      const int activeSetSize, const ViewVector_d b0)
+  {
+    const std::string kokkosLabelPrefix = "SolveActiveSetIteratively(); ";
+    const ScopedRegion region("nonlinearSolve: GMRES");
+
+    // Dimension of the Krylov subspace before a restart, and maximum number of restarts
+    constexpr int restart = 30;
+    constexpr int maxRestarts = 50;
+
+    const int n = activeSetSize;
+    const int n0 = matrix.Size();
+    preconditioner.Update(activeInactiveSet, n);
+
+    ViewVector_d b(kokkosLabelPrefix + "b", n);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "b", n,
+        KOKKOS_LAMBDA(const int i) { b(i) = b0(activeInactiveSet(i)); });
+
+    // y = H_I x
+    ViewVector_d full(kokkosLabelPrefix + "full", n0);
+    ViewVector_d product(kokkosLabelPrefix + "product", n0);
+    const auto multiply = [&](const ViewVector_d y, const ViewVector_d x) {
+      Kokkos::deep_copy(full, 0.0);
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "scatter", n,
+          KOKKOS_LAMBDA(const int i) { full(activeInactiveSet(i)) = x(i); });
+      matrix.Apply(product, full);
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "gather", n,
+          KOKKOS_LAMBDA(const int i) { y(i) = product(activeInactiveSet(i)); });
+    };
+    const auto dot = [&](const ViewVector_d x, const ViewVector_d y) {
+      double result = 0.0;
+      Kokkos::parallel_reduce(
+          kokkosLabelPrefix + "dot", n,
+          KOKKOS_LAMBDA(const int i, double& sum) { sum += x(i) * y(i); }, result);
+      return result;
+    };
+
+    const double tolerance = matrix.Tolerance() * std::sqrt(dot(b, b));
+
+    // Krylov basis, Hessenberg matrix (column major), Givens rotations and right-hand side of the
+    // least squares problem
+    ViewMatrix_d V(kokkosLabelPrefix + "V", n, restart + 1);
+    ViewVector_d z(kokkosLabelPrefix + "z", n);
+    ViewVector_d w(kokkosLabelPrefix + "w", n);
+    std::vector<double> h((restart + 1) * restart), cs(restart), sn(restart), g(restart + 1);
+
+    // Residual r = b - H_I s and its norm
+    const auto residual = [&](const ViewVector_d r) {
+      multiply(w, s);
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "residual", n, KOKKOS_LAMBDA(const int i) { r(i) = b(i) - w(i); });
+      return std::sqrt(dot(r, r));
+    };
+
+    bool converged = false;
+    for (int cycle = 0; cycle < maxRestarts && !converged; ++cycle)
+    {
+      const auto v0 = Kokkos::subview(V, Kokkos::ALL, 0);
+      const double beta = residual(v0);
+      if (beta <= tolerance)
+      {
+        converged = true;
+        break;
+      }
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "v0", n, KOKKOS_LAMBDA(const int i) { v0(i) /= beta; });
+      std::fill(g.begin(), g.end(), 0.0);
+      g[0] = beta;
+
+      int j = 0;
+      while (j < restart && !converged)
+      {
+        // Arnoldi step with modified Gram-Schmidt
+        const auto vj = Kokkos::subview(V, Kokkos::ALL, j);
+        preconditioner.Apply(z, vj);
+        multiply(w, z);
+        for (int i = 0; i <= j; ++i)
+        {
+          const auto vi = Kokkos::subview(V, Kokkos::ALL, i);
+          const double hij = dot(w, vi);
+          h[j * (restart + 1) + i] = hij;
+          Kokkos::parallel_for(
+              kokkosLabelPrefix + "orthogonalize", n,
+              KOKKOS_LAMBDA(const int k) { w(k) -= hij * vi(k); });
+        }
+        const double norm = std::sqrt(dot(w, w));
+        h[j * (restart + 1) + j + 1] = norm;
+        if (norm > 0)
+        {
+          const auto vNext = Kokkos::subview(V, Kokkos::ALL, j + 1);
+          Kokkos::parallel_for(
+              kokkosLabelPrefix + "normalize", n,
+              KOKKOS_LAMBDA(const int k) { vNext(k) = w(k) / norm; });
+        }
+
+        // Givens rotations of the new column of the Hessenberg matrix
+        double* column = &h[j * (restart + 1)];
+        for (int i = 0; i < j; ++i)
+        {
+          const double tmp = cs[i] * column[i] + sn[i] * column[i + 1];
+          column[i + 1] = -sn[i] * column[i] + cs[i] * column[i + 1];
+          column[i] = tmp;
+        }
+        const double radius = std::hypot(column[j], column[j + 1]);
+        cs[j] = column[j] / radius;
+        sn[j] = column[j + 1] / radius;
+        column[j] = radius;
+        column[j + 1] = 0.0;
+        g[j + 1] = -sn[j] * g[j];
+        g[j] = cs[j] * g[j];
+
+        ++j;
+        converged = std::abs(g[j]) <= tolerance || norm == 0;
+      }
+
+      // s += M^{-1} V y with the solution y of the triangular least squares problem
+      std::vector<double> y(j);
+      for (int i = j - 1; i >= 0; --i)
+      {
+        y[i] = g[i];
+        for (int k = i + 1; k < j; ++k) y[i] -= h[k * (restart + 1) + i] * y[k];
+        y[i] /= h[i * (restart + 1) + i];
+      }
+      Kokkos::deep_copy(w, 0.0);
+      for (int i = 0; i < j; ++i)
+      {
+        const auto vi = Kokkos::subview(V, Kokkos::ALL, i);
+        const double yi = y[i];
+        Kokkos::parallel_for(
+            kokkosLabelPrefix + "update", n, KOKKOS_LAMBDA(const int k) { w(k) += yi * vi(k); });
+      }
+      preconditioner.Apply(z, w);
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "s", n, KOKKOS_LAMBDA(const int k) { s(k) += z(k); });
+    }
+
+    if (!converged)
+    {
+      // The contact forces would not satisfy the active set system to the tolerance of the
+      // H-matrix, so stop instead of continuing the nonlinear solver with them
+      const double normB = std::sqrt(dot(b, b));
+      std::ostringstream message;
+      message << "GMRES did not converge in " << maxRestarts << " restarts of " << restart
+              << " iterations for an active set of " << n << " points: relative residual "
+              << residual(z) / normB << " > " << matrix.Tolerance();
+      throw std::runtime_error(message.str());
+    }
+  }
+
+  /**
+   * @brief Apply the row interchanges of an LU factorization from KokkosLapack::gesv() (1-based, as
+   * in LAPACK) to all columns of a matrix
+   *
+   * @tparam MatrixView ViewMatrix_d or ViewMatrixFloat_d
+   * @param[in] ipiv Row interchanges of the factorization
+   * @param[in,out] x Matrix whose rows are interchanged
+   */
+  template <typename MatrixView>
+  void ApplyRowInterchanges(const ViewVectorInt_d ipiv, const MatrixView x)
+  {
+    using Scalar = typename MatrixView::non_const_value_type;
+    const int n = ipiv.extent(0);
+    Kokkos::parallel_for(
+        "ApplyRowInterchanges()", x.extent(0) > 0 ? x.extent(1) : 0, KOKKOS_LAMBDA(const int j) {
+          for (int i = 0; i < n; ++i)
+          {
+            const int k = ipiv(i) - 1;
+            const Scalar tmp = x(i, j);
+            x(i, j) = x(k, j);
+            x(k, j) = tmp;
+          }
+        });
+  }
+
+  /**
+   * @brief Solve a system with the LU factorization of its matrix from KokkosLapack::gesv(): the
+   * row interchanges of the factorization, then the triangular solves
+   *
+   * @tparam MatrixView ViewMatrix_d or ViewMatrixFloat_d
+   * @param[in] lu LU factors, which overwrote the matrix in gesv()
+   * @param[in] ipiv Row interchanges of the factorization
+   * @param[in,out] x Right-hand sides and solutions
+   */
+  template <typename MatrixView>
+  void SolveFactorized(const MatrixView lu, const ViewVectorInt_d ipiv, const MatrixView x)
+  {
+    using Scalar = typename MatrixView::non_const_value_type;
+    ApplyRowInterchanges(ipiv, x);
+    KokkosBlas::trsm("L", "L", "N", "U", Scalar(1), lu, x);
+    KokkosBlas::trsm("L", "U", "N", "N", Scalar(1), lu, x);
+  }
+
+  /**
+   * @brief Extend the LU factorization of H_I from gesv() for the first n points of the active set
+   * to all of its n + k points: with the factorization P A = L U of the leading block of
+   * H_I = [A B; C D] and the one of the Schur complement S = D - C A^{-1} B, P_S S = L_S U_S,
+   *
+   *   [P 0; 0 P_S] H_I = [L 0; P_S C U^{-1} L_S] [U L^{-1} P B; 0 U_S],
+   *
+   * which costs O(n^2 k) instead of O((n + k)^3) for a new factorization. The rows are only
+   * interchanged within the blocks, which does not harm the stability since H_I is symmetric
+   * positive definite.
+   *
+   * @tparam MatrixType ViewMatrix_d, InfluenceKernelMatrix or CachedColumnsMatrix
+   * @param[in,out] factorization LU factors of the first n points, becomes the ones of all points
+   * @param[in,out] pivots Row interchanges of the factorization
+   * @param[in] matrix Influence coefficient matrix of all predicted points
+   * @param[in] activeInactiveSet The active set are its first activeSetSize entries
+   */
+  template <typename MatrixType>
+  void ExtendFactorization(ViewMatrix_d& factorization, ViewVectorInt_d& pivots,
+      const MatrixType matrix, const ViewVectorInt_d activeInactiveSet, const int activeSetSize)
+  {
+    const std::string kokkosLabelPrefix = "ExtendFactorization(); ";
+    const ScopedRegion region("nonlinearSolve: extend factorization");
+    const ViewMatrix_d lu = factorization;
+    const ViewVectorInt_d ipiv = pivots;
+    const int n = lu.extent(0);
+    const int k = activeSetSize - n;
+
+    // Blocks B, C and D of H_I; B becomes L^{-1} P B, C becomes C U^{-1} and D becomes S
+    ViewMatrix_d B(kokkosLabelPrefix + "B", n, k);
+    ViewMatrix_d C(kokkosLabelPrefix + "C", k, n);
+    ViewMatrix_d S(kokkosLabelPrefix + "S", k, k);
+    Kokkos::parallel_for(kokkosLabelPrefix + "B, C",
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {n, k}),
+        KOKKOS_LAMBDA(const int i, const int j) {
+          B(i, j) = matrix(activeInactiveSet(i), activeInactiveSet(n + j));
+          C(j, i) = matrix(activeInactiveSet(n + j), activeInactiveSet(i));
+        });
+    ApplyRowInterchanges(ipiv, B);
+    KokkosBlas::trsm("L", "L", "N", "U", 1.0, lu, B);
+    KokkosBlas::trsm("R", "U", "N", "N", 1.0, lu, C);
+    Kokkos::parallel_for(kokkosLabelPrefix + "S",
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {k, k}),
+        KOKKOS_LAMBDA(const int i, const int j) {
+          double sum = matrix(activeInactiveSet(n + i), activeInactiveSet(n + j));
+          for (int l = 0; l < n; ++l) sum -= C(i, l) * B(l, j);
+          S(i, j) = sum;
+        });
+
+    // S becomes its LU factorization
+    ViewVector_d rhs(kokkosLabelPrefix + "rhs", k);
+    ViewVectorInt_d ipivS(kokkosLabelPrefix + "ipivS", k);
+    KokkosLapack::gesv(S, rhs, ipivS);
+    ApplyRowInterchanges(ipivS, C);
+
+    factorization = ViewMatrix_d(kokkosLabelPrefix + "factorization", activeSetSize, activeSetSize);
+    pivots = ViewVectorInt_d(kokkosLabelPrefix + "pivots", activeSetSize);
+    const ViewMatrix_d extended = factorization;
+    const ViewVectorInt_d extendedPivots = pivots;
+    Kokkos::parallel_for(kokkosLabelPrefix + "factorization",
+        Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {activeSetSize, activeSetSize}),
+        KOKKOS_LAMBDA(const int i, const int j) {
+          if (i < n)
+            extended(i, j) = j < n ? lu(i, j) : B(i, j - n);
+          else
+            extended(i, j) = j < n ? C(i - n, j) : S(i - n, j - n);
+        });
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "pivots", activeSetSize, KOKKOS_LAMBDA(const int i) {
+          extendedPivots(i) = i < n ? ipiv(i) : ipivS(i - n) + n;
+        });
+  }
+
+  /**
+   * @brief Order the initial active set, i.e. the points with p >= nnlstol, like the active set of
+   * a previous solution: its points which are still in the initial active set come first, in their
+   * previous order, followed by the other points of the initial active set and then by the inactive
+   * points, both in ascending order
+   *
+   * @param[out] activeInactiveSet Positions of all predicted points in this order
+   * @param[in] activeSet0 Points predicted to be in contact (indices of the grid points)
+   * @param[in] p full contact forces vector initial guess
+   * @param[in] previousActiveSet Ordered active set of the previous solution (indices of the grid
+   * points)
+   * @param[in] nnlstol tolerance of the nonlinear solver
+   * @param[out] kept Number of points of the previous active set which are still in the initial
+   * active set, i.e. which come first
+   *
+   * @return Size of the initial active set
+   */
+  int OrderActiveSet(const ViewVectorInt_d activeInactiveSet,
+      const ViewVectorGridIndex_d activeSet0, const ViewVector_d p,
+      const ViewVectorGridIndex_d previousActiveSet, const double nnlstol, int& kept)
+  {
+    const std::string kokkosLabelPrefix = "OrderActiveSet(); ";
+    const int n0 = activeSet0.extent(0);
+    const int nPrevious = previousActiveSet.extent(0);
+
+    // Position of the points of the previous active set among the predicted points if they are in
+    // the initial active set, -1 otherwise, and which predicted points they are
+    const GridIndexMap predictedPosition(activeSet0, kokkosLabelPrefix + "predictedPosition");
+    ViewVectorInt_d previousPosition(kokkosLabelPrefix + "previousPosition", nPrevious);
+    ViewVectorInt_d previous(kokkosLabelPrefix + "previous", n0);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "previousPosition", nPrevious, KOKKOS_LAMBDA(const int j) {
+          const int i = predictedPosition(previousActiveSet(j));
+          previousPosition(j) = -1;
+          if (i >= 0 && p(i) >= nnlstol)
+          {
+            previousPosition(j) = i;
+            previous(i) = 1;
+          }
+        });
+
+    kept = 0;
+    Kokkos::parallel_scan(
+        kokkosLabelPrefix + "previous active set", nPrevious,
+        KOKKOS_LAMBDA(const int j, int& position, const bool final) {
+          if (previousPosition(j) >= 0)
+          {
+            if (final) activeInactiveSet(position) = previousPosition(j);
+            ++position;
+          }
+        },
+        kept);
+
+    const int keptSize = kept;
+    int added = 0;
+    Kokkos::parallel_scan(
+        kokkosLabelPrefix + "new active set", n0,
+        KOKKOS_LAMBDA(const int i, int& position, const bool final) {
+          if (p(i) >= nnlstol && !previous(i))
+          {
+            if (final) activeInactiveSet(keptSize + position) = i;
+            ++position;
+          }
+        },
+        added);
+
+    const int activeSetSize = kept + added;
+    Kokkos::parallel_scan(
+        kokkosLabelPrefix + "inactive set", n0,
+        KOKKOS_LAMBDA(const int i, int& position, const bool final) {
+          if (!(p(i) >= nnlstol))
+          {
+            if (final) activeInactiveSet(activeSetSize + position) = i;
+            ++position;
+          }
+        });
+
+    return activeSetSize;
+  }
+
+  /**
+   * @brief Matrix whose entries are read from a cache of some of its columns if they are cached,
+   * and from the underlying matrix otherwise
+   */
+  template <typename MatrixType>
+  struct CachedColumnsMatrix
+  {
+    MatrixType matrix;
+    // Cached columns, and the column of the cache of every column of the matrix (-1 if it is not
+    // cached)
+    ViewMatrix_d columns;
+    ViewVectorInt_d slot;
+
+    KOKKOS_INLINE_FUNCTION double operator()(const int i, const int j) const
+    {
+      const int k = slot(j);
+      return k >= 0 ? columns(i, k) : matrix(i, j);
+    }
+  };
+
+  /**
+   * @brief Cache of the columns of the influence coefficient matrix of the active set. Only the
+   * entries of an OnTheFlyMatrix are expensive (every access evaluates the Green function), so the
+   * other matrices are used directly.
+   */
+  template <typename MatrixType>
+  class ActiveColumnCache
+  {
+   public:
+    ActiveColumnCache(const MatrixType& matrix, const int, const std::size_t) : matrix_(matrix) {}
+
+    void Update(const ViewVectorInt_d, const int) {}
+
+    const MatrixType& Matrix() const { return matrix_; }
+
+   private:
+    const MatrixType& matrix_;
+  };
+
+  /**
+   * @brief Cache of the columns of an OnTheFlyMatrix of the active set: the active set changes by
+   * one point per pivot, so only the column of the new point has to be computed, instead of all
+   * columns of the active set for every update of the gaps w and for every H_I.
+   *
+   * The columns are cached as long as they fit, together with H_I, into the memory of an H_I of all
+   * n0 predicted points, which EstimateSolverMemory() counts for the nonlinear solver. H_I is
+   * reserved in double precision, such that the double precision fallback of the mixed precision
+   * solver fits as well. The entries of the other columns are computed whenever they are needed.
+   */
+  template <typename GreenFunction>
+  class ActiveColumnCache<OnTheFlyMatrix<GreenFunction>>
+  {
+   public:
+    /**
+     * @param[in] matrix Influence coefficient matrix of all predicted points
+     * @param[in] n0 Number of predicted points
+     * @param[in] activeSetEntrySize Size of an entry of H_I [bytes]
+     */
+    ActiveColumnCache(const OnTheFlyMatrix<GreenFunction>& matrix, const int n0,
+        const std::size_t activeSetEntrySize)
+        : matrix_(matrix),
+          n0_(n0),
+          activeSetEntrySize_(activeSetEntrySize),
+          columns_("ActiveColumnCache; columns", n0, 0),
+          slot_("ActiveColumnCache; slot", n0),
+          slot_h_("ActiveColumnCache; slot_h", n0),
+          active_(n0)
+    {
+      Kokkos::deep_copy(slot_h_, -1);
+      Kokkos::deep_copy(slot_, slot_h_);
+    }
+
+    /**
+     * @brief Cache the columns of the active set which are not cached yet, in place of the columns
+     * of points which are not active anymore
+     *
+     * @param[in] activeInactiveSet The active set are its first activeSetSize entries
+     */
+    void Update(const ViewVectorInt_d activeInactiveSet, const int activeSetSize)
+    {
+      const std::string kokkosLabelPrefix = "ActiveColumnCache::Update(); ";
+      const auto activeSet = Kokkos::create_mirror_view_and_copy(MemorySpace_Host_t(),
+          Kokkos::subview(activeInactiveSet, std::make_pair(0, activeSetSize)));
+      std::fill(active_.begin(), active_.end(), 0);
+      for (int i = 0; i < activeSetSize; ++i) active_[activeSet(i)] = 1;
+
+      // The memory of an H_I of all predicted points which the current H_I does not need
+      const std::size_t n0 = n0_;
+      const std::size_t n = activeSetSize;
+      const std::size_t available = n0 * n0 * activeSetEntrySize_;
+      const std::size_t activeSetMemory = n * n * sizeof(double);
+      const std::size_t maxColumns =
+          available > activeSetMemory ? (available - activeSetMemory) / (n0 * sizeof(double)) : 0;
+
+      // Drop the last columns if the active set grew beyond them, down to half of the available
+      // memory; it only grows again below half of it, such that it is only copied a few times
+      if (owner_.size() > maxColumns)
+      {
+        const std::size_t newCapacity = maxColumns / 2;
+        for (std::size_t k = newCapacity; k < owner_.size(); ++k)
+          if (owner_[k] >= 0) slot_h_(owner_[k]) = -1;
+        owner_.resize(newCapacity);
+        Kokkos::resize(columns_, n0_, newCapacity);
+      }
+
+      int freeSlots = 0;
+      for (int& point : owner_)
+      {
+        if (point >= 0 && !active_[point])
+        {
+          slot_h_(point) = -1;
+          point = -1;
+        }
+        if (point < 0) ++freeSlots;
+      }
+
+      std::vector<int> missing;
+      for (int i = 0; i < activeSetSize; ++i)
+        if (slot_h_(activeSet(i)) < 0) missing.push_back(activeSet(i));
+
+      // Grow the cache geometrically up to the available memory, unless it already has half of it
+      const std::size_t capacity = owner_.size();
+      if (missing.size() > static_cast<std::size_t>(freeSlots) && capacity < maxColumns / 2)
+      {
+        const std::size_t newCapacity = std::min(maxColumns,
+            std::max(2 * capacity, capacity + missing.size() - freeSlots));
+        Kokkos::resize(columns_, n0_, newCapacity);
+        owner_.resize(newCapacity, -1);
+      }
+
+      // Compute the missing columns which fit into the free slots
+      std::vector<std::pair<int, int>> assigned;
+      std::size_t next = 0;
+      for (int k = 0; k < static_cast<int>(owner_.size()) && next < missing.size(); ++k)
+      {
+        if (owner_[k] >= 0) continue;
+        owner_[k] = missing[next];
+        slot_h_(missing[next]) = k;
+        assigned.emplace_back(k, missing[next]);
+        ++next;
+      }
+      if (assigned.empty())
+      {
+        Kokkos::deep_copy(slot_, slot_h_);
+        return;
+      }
+
+      const int count = assigned.size();
+      ViewVectorInt_h newSlots_h(kokkosLabelPrefix + "newSlots_h", count);
+      ViewVectorInt_h newPoints_h(kokkosLabelPrefix + "newPoints_h", count);
+      for (int k = 0; k < count; ++k)
+      {
+        newSlots_h(k) = assigned[k].first;
+        newPoints_h(k) = assigned[k].second;
+      }
+      const auto newSlots = Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(),
+          newSlots_h);
+      const auto newPoints = Kokkos::create_mirror_view_and_copy(MemorySpace_ofDefaultExec_t(),
+          newPoints_h);
+      const OnTheFlyMatrix<GreenFunction> matrix = matrix_;
+      const ViewMatrix_d columns = columns_;
+      Kokkos::parallel_for(kokkosLabelPrefix + "columns",
+          Kokkos::MDRangePolicy<Kokkos::Rank<2>>({0, 0}, {n0_, count}),
+          KOKKOS_LAMBDA(const int i, const int k) {
+            columns(i, newSlots(k)) = matrix(i, newPoints(k));
+          });
+      Kokkos::deep_copy(slot_, slot_h_);
+    }
+
+    /**
+     * @brief Matrix which reads the cached columns; it is only valid until the next Update()
+     */
+    CachedColumnsMatrix<OnTheFlyMatrix<GreenFunction>> Matrix() const
+    {
+      return {matrix_, columns_, slot_};
+    }
+
+   private:
+    OnTheFlyMatrix<GreenFunction> matrix_;
+    int n0_;
+    std::size_t activeSetEntrySize_;
+    ViewMatrix_d columns_;
+    ViewVectorInt_d slot_;
+    ViewVectorInt_h slot_h_;
+    // Point whose column is cached in every column of the cache (-1 if it is free), and whether
+    // every predicted point is active
+    std::vector<int> owner_;
+    std::vector<char> active_;
+  };
+
+  /**
+   * @brief Solve H_I s_I = b0_I with the LU factorization of H_I in single precision and iterative
+   * refinement: the corrections are solved in single precision for the residuals computed in double
+   * precision, until they are negligible compared to s_I
+   *
+   * @tparam MatrixType ViewMatrix_d, InfluenceKernelMatrix or CachedColumnsMatrix
+   * @param[out] s Solution s_I
+   * @param[in] matrix Influence coefficient matrix of all predicted points
+   * @param[in] activeInactiveSet The active set are its first activeSetSize entries
+   * @param[in] b0 Indentation value of the half space at the predicted points of contact
+   *
+   * @return Whether the refinement reached double precision accuracy; otherwise H_I is too
+   * ill-conditioned for the single precision factorization
+   */
+  template <typename MatrixType>
+  bool SolveActiveSetMixedPrecision(ViewVector_d s, const MatrixType matrix,
+      const ViewVectorInt_d activeInactiveSet, const int activeSetSize, const ViewVector_d b0)
+  {
+    const std::string kokkosLabelPrefix = "SolveActiveSetMixedPrecision(); ";
+    const ScopedRegion region("nonlinearSolve: mixed precision");
+
+    // The refinement converges linearly with a rate of about the condition number of H_I times the
+    // single precision epsilon. It stops once the corrections reach the rounding errors of the
+    // residual, or if they do not at least halve anymore.
+    constexpr int maxSteps = 10;
+    constexpr double eps = std::numeric_limits<double>::epsilon();
+    const double relativeTolerance = std::sqrt(static_cast<double>(activeSetSize)) * eps;
+
+    // Accuracy below which the refinement fails
+    constexpr double failureTolerance = 1e-12;
+
+    const int n = activeSetSize;
+    ViewMatrixFloat_d H_compact(kokkosLabelPrefix + "H_compact", n, n);
+    ViewVector_d r(kokkosLabelPrefix + "r", n);
+    Kokkos::parallel_for(
+        kokkosLabelPrefix + "H_compact", n, KOKKOS_LAMBDA(const int i) {
+          const int row = activeInactiveSet(i);
+          r(i) = b0(row);
+          s(i) = 0.0;
+          for (int j = 0; j < n; ++j)
+            H_compact(i, j) = static_cast<float>(matrix(row, activeInactiveSet(j)));
+        });
+
+    ViewMatrixFloat_d correction(kokkosLabelPrefix + "correction", n, 1);
+    ViewVectorInt_d ipiv(kokkosLabelPrefix + "ipiv", n);
+    double relativeCorrection = std::numeric_limits<double>::max();
+    double previousCorrection = std::numeric_limits<double>::max();
+    for (int step = 0; step < maxSteps; ++step)
+    {
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "rhs", n,
+          KOKKOS_LAMBDA(const int i) { correction(i, 0) = static_cast<float>(r(i)); });
+      if (step == 0)
+      {
+        // H_compact becomes its LU factorization
+        KokkosLapack::gesv(H_compact, correction, ipiv);
+      }
+      else
+      {
+        SolveFactorized(H_compact, ipiv, correction);
+      }
+
+      double maxCorrection = 0.0;
+      Kokkos::parallel_reduce(
+          kokkosLabelPrefix + "update s", n,
+          KOKKOS_LAMBDA(const int i, double& rmax) {
+            const double d = correction(i, 0);
+            s(i) += d;
+            rmax = Kokkos::max(rmax, Kokkos::abs(d));
+          },
+          Kokkos::Max<double>(maxCorrection));
+      double maxSolution = 0.0;
+      Kokkos::parallel_reduce(
+          kokkosLabelPrefix + "max s", n,
+          KOKKOS_LAMBDA(const int i, double& rmax) { rmax = Kokkos::max(rmax, Kokkos::abs(s(i))); },
+          Kokkos::Max<double>(maxSolution));
+      relativeCorrection = maxCorrection / maxSolution;
+      if (relativeCorrection <= relativeTolerance || relativeCorrection > 0.5 * previousCorrection)
+        break;
+      previousCorrection = relativeCorrection;
+
+      // Residual r = b0_I - H_I s_I in double precision
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "residual", n, KOKKOS_LAMBDA(const int i) {
+            const int row = activeInactiveSet(i);
+            double sum = 0.0;
+            for (int j = 0; j < n; ++j) sum += matrix(row, activeInactiveSet(j)) * s(j);
+            r(i) = b0(row) - sum;
+          });
+    }
+    return relativeCorrection <= failureTolerance;
+  }
 }  // namespace
 
 namespace MIRCO
 {
-  void nonlinearSolve(ViewVector_d& pf, ViewVectorInt_d& activeSetf, ViewVector_d& p,
-      const ViewVectorInt_d activeSet0, const ViewMatrix_d matrix, const ViewVector_d b0,
-      double nnlstol, int maxiter)
+  template <typename MatrixType>
+  int nonlinearSolve(ViewVector_d& pf, ViewVectorGridIndex_d& activeSetf, ViewVector_d& p,
+      const ViewVectorGridIndex_d activeSet0, const MatrixType matrix, const ViewVector_d b0,
+      const bool mixedPrecision, NonlinearSolverState* state, double nnlstol, int maxiter)
   {
     using minloc_t = Kokkos::MinLoc<double, int, MemorySpace_ofDefaultExec_t>;
     using minloc_value_t = typename minloc_t::value_type;
     const std::string kokkosLabelPrefix = "nonlinearSolve(); ";
+    const ScopedRegion region("nonlinearSolve");
 
     constexpr double machine_eps = std::numeric_limits<double>::epsilon();
 
@@ -42,32 +702,70 @@ namespace MIRCO
     ViewVector_d w(kokkosLabelPrefix + "w", n0);
 
     ViewVectorInt_d activeInactiveSet(kokkosLabelPrefix + "activeInactiveSet", n0);
+    ActiveColumnCache<MatrixType> cache(
+        matrix, n0, mixedPrecision ? sizeof(float) : sizeof(double));
+
+    // The preconditioner of the iterative solver of H-matrices is only refactorized for the
+    // blocks whose active points changed
+    std::optional<HMatrix::Preconditioner> preconditioner;
+    if constexpr (std::is_same_v<MatrixType, HMatrix>) preconditioner.emplace(matrix);
+
+    // LU factorization of H_I from gesv() and its row interchanges if the active set system of the
+    // current active set was solved with it, and whether the next solve can reuse (or extend) it
+    ViewMatrix_d factorization;
+    ViewVectorInt_d pivots;
+    bool reuseFactorization = false;
 
-    ViewScalarInt_d counterActive(kokkosLabelPrefix + "counterActive");
-    Kokkos::deep_copy(counterActive, 0);
-    ViewScalarInt_d counterInactive(kokkosLabelPrefix + "counterInactive");
-    Kokkos::deep_copy(counterInactive, 0);
-    Kokkos::parallel_for(
-        n0, KOKKOS_LAMBDA(const int i) {
-          if (p(i) >= nnlstol)
-          {
-            // Note: atomic_fetch_add() returns the old value
-            activeInactiveSet(Kokkos::atomic_fetch_add(&counterActive(), 1)) = i;
-          }
-          else
-          {
-            activeInactiveSet(n0 - 1 - (Kokkos::atomic_fetch_add(&counterInactive(), 1))) = i;
-          }
-        });
     int activeSetSize;
-    Kokkos::deep_copy(activeSetSize, counterActive);
+    if (state && state->activeSet.extent(0) > 0)
+    {
+      // Start from the order of the previous active set, whose factorization remains valid as long
+      // as the initial active set begins with it. Further points of the initial active set, e.g.
+      // the ones added by ExtendContactSetEstimate(), extend the factorization in a single step,
+      // unless its double precision extension may exceed the memory of MixedPrecision.
+      int kept;
+      activeSetSize =
+          OrderActiveSet(activeInactiveSet, activeSet0, p, state->activeSet, nnlstol, kept);
+      const int nFactorized = state->factorization.extent(0);
+      if (nFactorized > 0 && nFactorized == kept &&
+          kept == static_cast<int>(state->activeSet.extent(0)) &&
+          (activeSetSize == kept || !mixedPrecision) && !std::is_same_v<MatrixType, HMatrix>)
+      {
+        factorization = state->factorization;
+        pivots = state->pivots;
+        reuseFactorization = true;
+      }
+      state->factorization = ViewMatrix_d();
+      state->pivots = ViewVectorInt_d();
+    }
+    else
+    {
+      ViewScalarInt_d counterActive(kokkosLabelPrefix + "counterActive");
+      Kokkos::deep_copy(counterActive, 0);
+      ViewScalarInt_d counterInactive(kokkosLabelPrefix + "counterInactive");
+      Kokkos::deep_copy(counterInactive, 0);
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "initial active set", n0, KOKKOS_LAMBDA(const int i) {
+            if (p(i) >= nnlstol)
+            {
+              // Note: atomic_fetch_add() returns the old value
+              activeInactiveSet(Kokkos::atomic_fetch_add(&counterActive(), 1)) = i;
+            }
+            else
+            {
+              activeInactiveSet(n0 - 1 - (Kokkos::atomic_fetch_add(&counterInactive(), 1))) = i;
+            }
+          });
+      Kokkos::deep_copy(activeSetSize, counterActive);
+    }
 
     bool init = false;
     if (activeSetSize == 0)
     {
       init = true;
       // Hp - b0 for p = 0
-      Kokkos::parallel_for(n0, KOKKOS_LAMBDA(const int i) { w(i) = -b0(i); });
+      Kokkos::parallel_for(
+          kokkosLabelPrefix + "initial w", n0, KOKKOS_LAMBDA(const int i) { w(i) = -b0(i); });
     }
 
     int iter = 0;
@@ -78,7 +776,7 @@ namespace MIRCO
           kokkosLabelPrefix + "minloc_w_i_d");
 
       Kokkos::parallel_reduce(
-          n0,
+          kokkosLabelPrefix + "min w", n0,
           KOKKOS_LAMBDA(const int i, minloc_value_t& ml) {
             const double wi = w(i);
             if (wi < ml.val)
@@ -98,7 +796,7 @@ namespace MIRCO
       {
         Kokkos::View<minloc_value_t, MemorySpace_ofDefaultExec_t> minloc_w_iInactive_d(
             kokkosLabelPrefix + "minloc_w_iInactive_d");
-        Kokkos::parallel_reduce(
+        Kokkos::parallel_reduce(kokkosLabelPrefix + "min w inactive",
             Kokkos::RangePolicy<ExecSpace_Default_t>(activeSetSize, n0),
             KOKKOS_LAMBDA(const int i, minloc_value_t& ml) {
               const double wi = w(activeInactiveSet(i));
@@ -126,38 +824,89 @@ namespace MIRCO
         // Compact versions of H and b0, i.e. H_I and \overbar{u}_I in line 6 of Algorithm 3,
         // (Bemporad & Paggi, 2015)
         ViewVector_d b0s_compact(kokkosLabelPrefix + "b0_compact", activeSetSize);
-        if (activeSetSize > 1)
+        cache.Update(activeInactiveSet, activeSetSize);
+        const auto& H = cache.Matrix();
         {
-          ViewMatrix_d H_compact(kokkosLabelPrefix + "H_compact", activeSetSize, activeSetSize);
+          const ScopedRegion region("nonlinearSolve: solve H_I s_I = b0_I");
+          if constexpr (std::is_same_v<MatrixType, HMatrix>)
+          {
+            // The current contact forces are the initial guess of the iterative solver
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "s_I initial guess", activeSetSize,
+                KOKKOS_LAMBDA(const int i) { b0s_compact(i) = p(activeInactiveSet(i)); });
+            SolveActiveSetIteratively(
+                b0s_compact, matrix, *preconditioner, activeInactiveSet, activeSetSize, b0);
+          }
+          else if (activeSetSize > 1 && reuseFactorization)
+          {
+            if (static_cast<int>(factorization.extent(0)) < activeSetSize)
+              ExtendFactorization(factorization, pivots, H, activeInactiveSet, activeSetSize);
+            ViewMatrix_d s(kokkosLabelPrefix + "s_I", activeSetSize, 1);
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "s_I rhs", activeSetSize,
+                KOKKOS_LAMBDA(const int i) { s(i, 0) = b0(activeInactiveSet(i)); });
+            SolveFactorized(factorization, pivots, s);
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "s_I", activeSetSize,
+                KOKKOS_LAMBDA(const int i) { b0s_compact(i) = s(i, 0); });
+          }
+          else if (activeSetSize > 1)
+          {
+            factorization = ViewMatrix_d();
+            pivots = ViewVectorInt_d();
 
-          Kokkos::parallel_for(
-              activeSetSize, KOKKOS_LAMBDA(const int i) {
-                const int row = activeInactiveSet(i);
-                b0s_compact(i) = b0(row);
-                for (int j = 0; j < activeSetSize; ++j)
-                {
-                  const int col = activeInactiveSet(j);
-                  H_compact(i, j) = matrix(row, col);
-                }
-              });
+            // The mixed precision solver fails if H_I is too ill-conditioned for single precision
+            if (!mixedPrecision ||
+                !SolveActiveSetMixedPrecision(
+                    b0s_compact, H, activeInactiveSet, activeSetSize, b0))
+            {
+              // EstimateSolverMemory() only counts an H_I of all predicted points in single
+              // precision, into which the double precision H_I has to fit
+              const std::size_t n = activeSetSize;
+              const std::size_t nPredicted = n0;
+              if (mixedPrecision &&
+                  n * n * sizeof(double) > nPredicted * nPredicted * sizeof(float))
+                throw std::runtime_error("H_I of " + std::to_string(activeSetSize) +
+                                         " active points is too ill-conditioned for MixedPrecision,"
+                                         " and its double precision fallback does not fit into the"
+                                         " memory of the solver; disable MixedPrecision");
+              ViewMatrix_d H_compact(kokkosLabelPrefix + "H_compact", activeSetSize, activeSetSize);
 
-          ViewVectorInt_d ipiv(kokkosLabelPrefix + "ipiv", activeSetSize);
+              Kokkos::parallel_for(
+                  kokkosLabelPrefix + "H_compact", activeSetSize, KOKKOS_LAMBDA(const int i) {
+                    const int row = activeInactiveSet(i);
+                    b0s_compact(i) = b0(row);
+                    for (int j = 0; j < activeSetSize; ++j)
+                    {
+                      const int col = activeInactiveSet(j);
+                      H_compact(i, j) = H(row, col);
+                    }
+                  });
 
-          // Solve H_I s_I = b0_I; b0s_compact becomes s_I
-          KokkosLapack::gesv(H_compact, b0s_compact, ipiv);
-        }
-        else if (activeSetSize == 1)
-        {
-          Kokkos::parallel_for(
-              1, KOKKOS_LAMBDA(const int) {
-                const int ii = activeInactiveSet(0);
-                b0s_compact(0) = b0(ii) / matrix(ii, ii);
-              });
+              ViewVectorInt_d ipiv(kokkosLabelPrefix + "ipiv", activeSetSize);
+
+              // Solve H_I s_I = b0_I; b0s_compact becomes s_I, and H_compact its LU factorization
+              KokkosLapack::gesv(H_compact, b0s_compact, ipiv);
+              factorization = H_compact;
+              pivots = ipiv;
+            }
+          }
+          else if (activeSetSize == 1)
+          {
+            factorization = ViewMatrix_d();
+            pivots = ViewVectorInt_d();
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "s_I", 1, KOKKOS_LAMBDA(const int) {
+                  const int ii = activeInactiveSet(0);
+                  b0s_compact(0) = b0(ii) / H(ii, ii);
+                });
+          }
+          reuseFactorization = false;
         }
 
         bool allGreater = true;
         Kokkos::parallel_reduce(
-            activeSetSize,
+            kokkosLabelPrefix + "check s_I", activeSetSize,
             KOKKOS_LAMBDA(const int i, bool& rallGreater) {
               const bool lesser = (b0s_compact(i) < -nnlstol);
               rallGreater = rallGreater && !lesser;
@@ -166,16 +915,29 @@ namespace MIRCO
         if (allGreater)
         {
           Kokkos::parallel_for(
-              activeSetSize,
+              kokkosLabelPrefix + "accept s_I", activeSetSize,
               KOKKOS_LAMBDA(const int i) { p(activeInactiveSet(i)) = b0s_compact(i); });
 
-          Kokkos::parallel_for(
-              n0, KOKKOS_LAMBDA(const int i) {
-                double sum = 0.0;
-                for (int j = 0; j < activeSetSize; ++j)
-                  sum += matrix(i, activeInactiveSet(j)) * b0s_compact(j);
-                w(i) = sum - b0(i);
-              });
+          if constexpr (std::is_same_v<MatrixType, HMatrix>)
+          {
+            ViewVector_d s(kokkosLabelPrefix + "s", n0);
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "s", activeSetSize,
+                KOKKOS_LAMBDA(const int i) { s(activeInactiveSet(i)) = b0s_compact(i); });
+            matrix.Apply(w, s);
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "update w", n0, KOKKOS_LAMBDA(const int i) { w(i) -= b0(i); });
+          }
+          else
+          {
+            Kokkos::parallel_for(
+                kokkosLabelPrefix + "update w", n0, KOKKOS_LAMBDA(const int i) {
+                  double sum = 0.0;
+                  for (int j = 0; j < activeSetSize; ++j)
+                    sum += H(i, activeInactiveSet(j)) * b0s_compact(j);
+                  w(i) = sum - b0(i);
+                });
+          }
 
           break;
         }
@@ -185,7 +947,7 @@ namespace MIRCO
           Kokkos::View<minloc_value_t, MemorySpace_ofDefaultExec_t> minloc_alpha_i_d(
               kokkosLabelPrefix + "minloc_alpha_i_d");
           Kokkos::parallel_reduce(
-              activeSetSize,
+              kokkosLabelPrefix + "min alpha", activeSetSize,
               KOKKOS_LAMBDA(const int i, minloc_value_t& ml) {
                 if (b0s_compact(i) <= 0)
                 {
@@ -204,7 +966,7 @@ namespace MIRCO
           Kokkos::deep_copy(minloc_alpha_i_h, minloc_alpha_i_d);
 
           Kokkos::parallel_for(
-              activeSetSize, KOKKOS_LAMBDA(const int i) {
+              kokkosLabelPrefix + "step p", activeSetSize, KOKKOS_LAMBDA(const int i) {
                 p(activeInactiveSet(i)) =
                     p(activeInactiveSet(i)) +
                     minloc_alpha_i_d().val * (b0s_compact(i) - p(activeInactiveSet(i)));
@@ -222,13 +984,110 @@ namespace MIRCO
     }
     // Construct the final active set (the lower half of activeInactiveSet), as well as the compact
     // final pressure vector
-    activeSetf = ViewVectorInt_d("activeSetf", activeSetSize);
+    activeSetf = ViewVectorGridIndex_d("activeSetf", activeSetSize);
     pf = ViewVector_d("pf", activeSetSize);
     Kokkos::parallel_for(
-        activeSetSize, KOKKOS_LAMBDA(const int i) {
+        kokkosLabelPrefix + "final active set", activeSetSize, KOKKOS_LAMBDA(const int i) {
           activeSetf(i) = activeSet0(activeInactiveSet(i));
           pf(i) = p(activeInactiveSet(i));
         });
+
+    // The factorization belongs to the final active set, as every change of the active set is
+    // followed by a solve
+    if (state)
+    {
+      state->activeSet = activeSetf;
+      state->factorization = factorization;
+      state->pivots = pivots;
+    }
+    return iter;
+  }
+
+  bool UniformIndentationResponse(
+      ViewVector_d& z, const NonlinearSolverState& state, const double selfCoefficient)
+  {
+    const std::string kokkosLabelPrefix = "UniformIndentationResponse(); ";
+    const ScopedRegion region("UniformIndentationResponse");
+    const int n = state.activeSet.extent(0);
+    if (n > 1 && static_cast<int>(state.factorization.extent(0)) != n) return false;
+
+    ViewMatrix_d s(kokkosLabelPrefix + "z", n, 1);
+    Kokkos::deep_copy(s, n == 1 ? 1.0 / selfCoefficient : 1.0);
+    if (n > 1) SolveFactorized(state.factorization, state.pivots, s);
+    z = Kokkos::subview(s, Kokkos::ALL, 0);
+    return true;
+  }
+
+  template <typename MatrixType>
+  bool ShiftActiveSetSolution(ViewVector_d& pf, const ViewVectorGridIndex_d activeSetf,
+      const ViewVector_d z, const double shift, const ViewVectorGridIndex_d activeSet0,
+      const MatrixType matrix, const ViewVector_d b0, double nnlstol)
+  {
+    const std::string kokkosLabelPrefix = "ShiftActiveSetSolution(); ";
+    const ScopedRegion region("ShiftActiveSetSolution");
+    const int n0 = activeSet0.extent(0);
+    const int nf = activeSetf.extent(0);
+
+    // Position of every grid point in the predicted contact set, -1 if it is not predicted
+    const GridIndexMap position(activeSet0, kokkosLabelPrefix + "position");
+
+    // The active set has to remain predicted, with contact forces p_I + shift z >= nnlstol
+    ViewVectorInt_d positionf(kokkosLabelPrefix + "positionf", nf);
+    ViewVectorInt_d active(kokkosLabelPrefix + "active", n0);
+    ViewVector_d p(kokkosLabelPrefix + "p", nf);
+    bool valid = true;
+    Kokkos::parallel_reduce(
+        kokkosLabelPrefix + "p", nf,
+        KOKKOS_LAMBDA(const int j, bool& rvalid) {
+          const int i = position(activeSetf(j));
+          positionf(j) = i;
+          if (i >= 0) active(i) = 1;
+          p(j) = pf(j) + shift * z(j);
+          rvalid = rvalid && i >= 0 && p(j) >= nnlstol;
+        },
+        Kokkos::LAnd<bool>(valid));
+
+    // The gaps w = H p - b0 of the other predicted points have to be at least -nnlstol
+    if (valid)
+    {
+      double minGap;
+      Kokkos::parallel_reduce(
+          kokkosLabelPrefix + "min w", n0,
+          KOKKOS_LAMBDA(const int i, double& rmin) {
+            if (active(i)) return;
+            double sum = 0.0;
+            for (int j = 0; j < nf; ++j) sum += matrix(i, positionf(j)) * p(j);
+            rmin = Kokkos::min(rmin, sum - b0(i));
+          },
+          Kokkos::Min<double>(minGap));
+      valid = minGap >= -nnlstol;
+    }
+    if (valid) pf = p;
+    return valid;
   }
 
+  template int nonlinearSolve(ViewVector_d&, ViewVectorGridIndex_d&, ViewVector_d&,
+      const ViewVectorGridIndex_d, const ViewMatrix_d, const ViewVector_d, const bool,
+      NonlinearSolverState*, double, int);
+  template int nonlinearSolve(ViewVector_d&, ViewVectorGridIndex_d&, ViewVector_d&,
+      const ViewVectorGridIndex_d, const OnTheFlyMatrix<PressureGreenFunction>, const ViewVector_d,
+      const bool, NonlinearSolverState*, double, int);
+  template int nonlinearSolve(ViewVector_d&, ViewVectorGridIndex_d&, ViewVector_d&,
+      const ViewVectorGridIndex_d, const OnTheFlyMatrix<PointForceGreenFunction>,
+      const ViewVector_d, const bool, NonlinearSolverState*, double, int);
+  template int nonlinearSolve(ViewVector_d&, ViewVectorGridIndex_d&, ViewVector_d&,
+      const ViewVectorGridIndex_d, const InfluenceKernelMatrix, const ViewVector_d, const bool,
+      NonlinearSolverState*, double, int);
+  template int nonlinearSolve(ViewVector_d&, ViewVectorGridIndex_d&, ViewVector_d&,
+      const ViewVectorGridIndex_d, const HMatrix, const ViewVector_d, const bool,
+      NonlinearSolverState*, double, int);
+  template bool ShiftActiveSetSolution(ViewVector_d&, const ViewVectorGridIndex_d,
+      const ViewVector_d, const double, const ViewVectorGridIndex_d,
+      const OnTheFlyMatrix<PressureGreenFunction>, const ViewVector_d, double);
+  template bool ShiftActiveSetSolution(ViewVector_d&, const ViewVectorGridIndex_d,
+      const ViewVector_d, const double, const ViewVectorGridIndex_d,
+      const OnTheFlyMatrix<PointForceGreenFunction>, const ViewVector_d, double);
+  template bool ShiftActiveSetSolution(ViewVector_d&, const ViewVectorGridIndex_d,
+      const ViewVector_d, const double, const ViewVectorGridIndex_d, const InfluenceKernelMatrix,
+      const ViewVector_d, double);
 }  // namespace MIRCO
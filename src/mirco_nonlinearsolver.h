@@ -5,6 +5,21 @@
 
 namespace MIRCO
 {
+  /**
+   * @brief State of the nonlinear solver at the end of a call of nonlinearSolve(), from which a
+   * later call with a similar problem restarts
+   */
+  struct NonlinearSolverState
+  {
+    // Active set in the order of the rows of H_I (indices of the grid points)
+    ViewVectorGridIndex_d activeSet;
+
+    // LU factorization of H_I from gesv() and its row interchanges if the last active set system
+    // was solved with it in double precision; empty otherwise
+    ViewMatrix_d factorization;
+    ViewVectorInt_d pivots;
+  };
+
   /**
    * @brief Solve the non-linear problem using a Non-Negative Least Squares (NNLS)
    *
@@ -16,15 +31,75 @@ namespace MIRCO
    * @param[out] activeSetf final active set at the end of the nonlinear solver
    * @param[in] p full contact forces vector initial guess
    * @param[in] activeSet0 active set initial guess
+   * @tparam MatrixType ViewMatrix_d for a stored influence coefficient matrix, OnTheFlyMatrix
+   * to compute its entries whenever they are needed, InfluenceKernelMatrix to look them up in the
+   * influence kernel, or HMatrix for a hierarchical approximation, whose active set systems are
+   * solved iteratively
    * @param[in] matrix Influence coefficient matrix (Discrete version of Green Function)
    * @param[in] b0 Indentation value of the half space at the predicted points of contact
+   * @param[in] mixedPrecision Store and factorize H_I in single precision, and refine the solutions
+   * of the active set systems iteratively to double precision (ignored for an HMatrix)
+   * @param[in,out] state If given, the state of a previous call is used to restart: the initial
+   * active set (the points with p >= nnlstol) is ordered like its active set, and its factorization
+   * solves the first active set system if the initial active set is the same. The state at the end
+   * of this call replaces it. The influence coefficients of the points have to be the same.
    * @param[in] nnlstol tolerance of the nonlinear solver; \epsilon in (Bemporad & Paggi, 2015)
    * @param[in] maxiter maximum number of total iterations of the innermost loop of the nonlinear
    * solver
+   *
+   * @return Number of iterations of the innermost loop, i.e. of changes (pivots) of the active set
    */
-  void nonlinearSolve(ViewVector_d& pf, ViewVectorInt_d& activeSetf, ViewVector_d& p,
-      const ViewVectorInt_d activeSet0, const ViewMatrix_d matrix, const ViewVector_d b0,
+  template <typename MatrixType>
+  int nonlinearSolve(ViewVector_d& pf, ViewVectorGridIndex_d& activeSetf, ViewVector_d& p,
+      const ViewVectorGridIndex_d activeSet0, const MatrixType matrix, const ViewVector_d b0,
+      const bool mixedPrecision = false, NonlinearSolverState* state = nullptr,
       double nnlstol = 1.0e-08, int maxiter = 10000);
+
+  /**
+   * @brief Solve H_I z = 1 for the influence coefficients H_I of the active set I of the last solve
+   * of nonlinearSolve(), i.e. compute the change of their contact forces if the indentation of all
+   * of them increases by one. The system is solved with the LU factorization of H_I in the state,
+   * such that H_I is neither assembled nor factorized again.
+   *
+   * @param[out] z Response of the contact forces at state.activeSet
+   * @param[in] state State at the end of nonlinearSolve()
+   * @param[in] selfCoefficient Influence coefficient of a point on itself, i.e. H_I of a single
+   * point, which is not factorized
+   *
+   * @return Whether z was computed; not if the state has no factorization of H_I, i.e. if the last
+   * active set system was solved in single precision, with GMRES or the factorization was dropped
+   */
+  bool UniformIndentationResponse(
+      ViewVector_d& z, const NonlinearSolverState& state, const double selfCoefficient);
+
+  /**
+   * @brief Solve the non-linear problem in closed form if its indentation differs from the one of
+   * a previous solution by a uniform shift and the active set does not change
+   *
+   * The elastic correction shifts the indentation b0 of all points by the same amount. If the
+   * active set I of the previous solution remains the active set, the new contact forces are
+   * p_I + shift z with z from UniformIndentationResponse(). This is the solution of
+   * nonlinearSolve() if it satisfies the same termination criteria, i.e. if all contact forces are
+   * at least nnlstol and the gaps w of all other predicted points are at least -nnlstol.
+   *
+   * @tparam MatrixType OnTheFlyMatrix or InfluenceKernelMatrix
+   * @param[in,out] pf Contact forces at the points in activeSetf; only updated if the closed form
+   * is the solution
+   * @param[in] activeSetf Active set of the previous solution (indices of the grid points)
+   * @param[in] z Response of the contact forces at activeSetf to a unit shift of the indentation
+   * @param[in] shift Shift of the indentation since the previous solution
+   * @param[in] activeSet0 Points predicted to be in contact (indices of the grid points)
+   * @param[in] matrix Influence coefficient matrix of the points predicted to be in contact, whose
+   * entries are computed whenever they are needed
+   * @param[in] b0 Indentation value of the half space at the predicted points of contact
+   * @param[in] nnlstol tolerance of the nonlinear solver (see nonlinearSolve())
+   *
+   * @return Whether the closed form is the solution; otherwise nonlinearSolve() has to be used
+   */
+  template <typename MatrixType>
+  bool ShiftActiveSetSolution(ViewVector_d& pf, const ViewVectorGridIndex_d activeSetf,
+      const ViewVector_d z, const double shift, const ViewVectorGridIndex_d activeSet0,
+      const MatrixType matrix, const ViewVector_d b0, double nnlstol = 1.0e-08);
 }  // namespace MIRCO
 
 #endif  // SRC_NONLINEARSOLVER_H_
@@ -1,6 +1,16 @@
 #include "mirco_shapefactors.h"
 
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <string>
+
+#include "mirco_flatindentor.h"
 
 namespace
 {
@@ -276,6 +286,52 @@ namespace
       0.8661019606243293, 0.8661048389180533, 0.8661077069557319};
   constexpr int shape_factors_force_length =
       sizeof(shape_factors_force) / sizeof(shape_factors_force[0]);
+
+  // Shape factors which are not part of the tables above are computed on demand and stored in a
+  // persistent cache file, such that they are computed only once for every N. Each line of the file
+  // contains N, PressureGreenFunFlag (0 or 1) and the shape factor.
+  std::mutex shape_factor_cache_mutex;
+
+  // Location of the cache file: $MIRCO_SHAPE_FACTOR_CACHE, $XDG_CACHE_HOME/mirco/shapefactors.dat
+  // or $HOME/.cache/mirco/shapefactors.dat, in this order. Returns an empty path if none of these
+  // environment variables is set.
+  std::filesystem::path ShapeFactorCachePath()
+  {
+    if (const char* path = std::getenv("MIRCO_SHAPE_FACTOR_CACHE")) return path;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"))
+      return std::filesystem::path(xdg) / "mirco" / "shapefactors.dat";
+    if (const char* home = std::getenv("HOME"))
+      return std::filesystem::path(home) / ".cache" / "mirco" / "shapefactors.dat";
+    return {};
+  }
+
+  std::optional<double> ReadCachedShapeFactor(
+      const std::filesystem::path& cachePath, const int N, const bool pressureGreenFunFlag)
+  {
+    std::ifstream file(cachePath);
+    int n;
+    int flag;
+    double value;
+    while (file >> n >> flag >> value)
+      if (n == N && flag == static_cast<int>(pressureGreenFunFlag)) return value;
+    return std::nullopt;
+  }
+
+  void WriteCachedShapeFactor(const std::filesystem::path& cachePath, const int N,
+      const bool pressureGreenFunFlag, const double value)
+  {
+    std::error_code error;
+    if (cachePath.has_parent_path())
+      std::filesystem::create_directories(cachePath.parent_path(), error);
+    std::ofstream file(cachePath, std::ios::app);
+    if (!file)
+    {
+      std::cerr << "WARNING: Could not write the shape factor cache " << cachePath << std::endl;
+      return;
+    }
+    file << N << " " << static_cast<int>(pressureGreenFunFlag) << " " << std::setprecision(17)
+         << value << "\n";
+  }
 }  // namespace
 
 double MIRCO::getShapeFactor(const int N, const bool pressureGreenFunFlag)
@@ -284,10 +340,37 @@ double MIRCO::getShapeFactor(const int N, const bool pressureGreenFunFlag)
   const int length =
       pressureGreenFunFlag ? shape_factors_pressure_length : shape_factors_force_length;
 
-  if (N < 0 || N >= length || shape_factors[N] == -1)
+  if (N <= 0)
     throw std::runtime_error(
         "No shape factor available for N=" + std::to_string(N) +
         " and PressureGreenFunFlag=" + (pressureGreenFunFlag ? "true" : "false"));
 
-  return shape_factors[N];
+  if (N < length && shape_factors[N] != -1) return shape_factors[N];
+
+  if (const auto cached = getCachedShapeFactor(N, pressureGreenFunFlag)) return *cached;
+
+  std::cout << "Computing the shape factor for N=" << N << " and PressureGreenFunFlag="
+            << (pressureGreenFunFlag ? "true" : "false") << " (not tabulated)" << std::endl;
+  const double shapeFactor = ComputeShapeFactor(N, pressureGreenFunFlag);
+  cacheShapeFactor(N, pressureGreenFunFlag, shapeFactor);
+
+  return shapeFactor;
+}
+
+std::optional<double> MIRCO::getCachedShapeFactor(const int N, const bool pressureGreenFunFlag)
+{
+  const std::filesystem::path cachePath = ShapeFactorCachePath();
+  if (cachePath.empty()) return std::nullopt;
+
+  std::lock_guard<std::mutex> lock(shape_factor_cache_mutex);
+  return ReadCachedShapeFactor(cachePath, N, pressureGreenFunFlag);
+}
+
+void MIRCO::cacheShapeFactor(const int N, const bool pressureGreenFunFlag, const double shapeFactor)
+{
+  const std::filesystem::path cachePath = ShapeFactorCachePath();
+  if (cachePath.empty()) return;
+
+  std::lock_guard<std::mutex> lock(shape_factor_cache_mutex);
+  WriteCachedShapeFactor(cachePath, N, pressureGreenFunFlag, shapeFactor);
 }
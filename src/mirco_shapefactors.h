@@ -1,9 +1,38 @@
 #ifndef SRC_DATA_SHAPEFACTORS_H_
 #define SRC_DATA_SHAPEFACTORS_H_
 
+#include <optional>
+
 namespace MIRCO
 {
+  /**
+   * @brief Get the shape factor for a grid with N elements along one direction (See section 3.3 of
+   * https://doi.org/10.1007/s00466-019-01791-3).
+   *
+   * Shape factors which are not tabulated are computed with ComputeShapeFactor() and stored in a
+   * persistent cache file, which is located at $MIRCO_SHAPE_FACTOR_CACHE if set, otherwise at
+   * $XDG_CACHE_HOME/mirco/shapefactors.dat or $HOME/.cache/mirco/shapefactors.dat.
+   *
+   * @param[in] N Element count along one direction
+   * @param[in] PressureGreenFunFlag Flag to use Green function based on uniform pressure instead
+   * of point force
+   *
+   * @return Shape factor
+   */
   double getShapeFactor(const int N, const bool PressureGreenFunFlag);
+
+  /**
+   * @brief Look up a shape factor in the persistent cache file (see getShapeFactor())
+   *
+   * @return Cached shape factor, or std::nullopt if there is none for N and PressureGreenFunFlag
+   */
+  std::optional<double> getCachedShapeFactor(const int N, const bool PressureGreenFunFlag);
+
+  /**
+   * @brief Append a shape factor to the persistent cache file (see getShapeFactor()). This is
+   * thread-safe, and every entry is written immediately.
+   */
+  void cacheShapeFactor(const int N, const bool PressureGreenFunFlag, const double shapeFactor);
 }  // namespace MIRCO
 
 #endif  // SRC_DATA_SHAPEFACTORS_H_
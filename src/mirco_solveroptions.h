@@ -0,0 +1,146 @@
+#ifndef SRC_SOLVEROPTIONS_H_
+#define SRC_SOLVEROPTIONS_H_
+
+#include <cstddef>
+
+namespace MIRCO
+{
+  class AsyncVisualizationWriter;
+  class Timings;
+
+  /**
+   * @brief Statistics of a run of the contact solver, which are independent of the machine
+   */
+  struct SolverStatistics
+  {
+    // Iterations of the elastic compliance correction (on all grids)
+    int outer_iterations = 0;
+
+    // Iterations of the innermost loop of the nonlinear solver, i.e. changes (pivots) of the active
+    // set (summed over all outer iterations)
+    int nnls_iterations = 0;
+
+    // Largest number of points predicted to be in contact, which determines the size of the
+    // influence coefficient matrix
+    int max_predicted_contacts = 0;
+
+    // Iterations of the elastic compliance correction in which the influence coefficients were
+    // computed on the fly instead of being stored (see SolverOptions::on_the_fly_matrix)
+    int on_the_fly_iterations = 0;
+
+    // Entries of all stored influence coefficient matrices, and the ones of them which were copied
+    // from the matrix of the previous iteration instead of being computed (see UpdateMatrix())
+    std::size_t matrix_entries = 0;
+    std::size_t reused_matrix_entries = 0;
+
+    // Iterations of the elastic compliance correction in which the active set did not change, such
+    // that the contact forces were updated in closed form (see ShiftActiveSetSolution()) instead of
+    // solving the nonlinear problem
+    int closed_form_iterations = 0;
+
+    // Points added to estimates of the contact set by their fallback, and the solves of the
+    // nonlinear problem for the extended estimates (see SolverOptions::contact_set_estimate)
+    int estimate_added_contacts = 0;
+    int estimate_extensions = 0;
+  };
+
+  /**
+   * @brief This struct stores optional algorithmic settings of the contact solver. The default
+   * values reproduce the standard algorithm, such that only the settings which deviate from it have
+   * to be set.
+   *
+   */
+  struct SolverOptions
+  {
+    // Number of coarser grids on which the contact problem is solved before the actual grid. The
+    // solution of each level is prolongated to the next finer level as its initial guess. A value
+    // of 0 disables the multilevel mode.
+    int multilevel_levels = 0;
+
+    // Write the fields of the visualization export in double instead of single precision
+    bool visualization_double_precision = false;
+
+    // zlib compression level (0 to 9) of the visualization export. A value of 0 disables the
+    // compression.
+    int visualization_compression_level = 5;
+
+    // Hand the visualization export of the mirco executable off to an AsyncVisualizationWriter,
+    // which also keeps a ParaView collection <export path>.pvd of the written files up to date
+    bool visualization_async = false;
+
+    // If set, the visualization export is handed off to this writer (with the far-field
+    // displacement as its time) instead of being written synchronously. The writer has to outlive
+    // the evaluation.
+    AsyncVisualizationWriter* visualization_writer = nullptr;
+
+    // If set, the wall-clock times of the phases of the solver (predictor, warmstart, assembly,
+    // nnls, export, and the coarse levels of the multilevel mode) are added to it. Timing fences
+    // all asynchronous kernels.
+    Timings* timings = nullptr;
+
+    // Print a hierarchical breakdown of the wall-clock times at the end of the mirco executable
+    bool print_timings = false;
+
+    // Memory budget [bytes] of the solver. If the estimated memory of an iteration with a stored
+    // influence coefficient matrix (see EstimateSolverMemory()) exceeds it, the iteration computes
+    // the matrix entries on the fly instead. If even that or the visualization export does not fit,
+    // an exception with a report of the estimate is thrown before the memory is allocated. A value
+    // of 0 disables the check.
+    std::size_t memory_budget = 0;
+
+    // Always compute the entries of the influence coefficient matrix whenever they are needed (see
+    // OnTheFlyMatrix) instead of storing the matrix. This saves the n^2 entries of the matrix for n
+    // predicted contact points, but is slower; only the compact matrix H_I of the nonlinear solver
+    // and the cached columns of its active set remain.
+    bool on_the_fly_matrix = false;
+
+    // Relative tolerance of a hierarchical matrix approximation of the influence coefficient matrix
+    // (see HMatrix), whose active set systems are solved iteratively to the same tolerance. This
+    // needs O(n log n) instead of O(n^2) memory and time for n predicted contact points. A value of
+    // 0 disables the approximation.
+    double hmatrix_tolerance = 0.0;
+
+    // Tolerance of the relative error of the influence coefficients beyond the near-field radius,
+    // where the Green function is replaced by its far-field expansion (see
+    // mirco_greenfunctions.h). A value of 0 disables the approximation.
+    double far_field_tolerance = 0.0;
+
+    // Minimum near-field radius [grid cells] within which the exact Green function is used. The
+    // radius is increased if the far-field tolerance requires it.
+    double near_field_radius = 0.0;
+
+    // Store the points predicted to be in contact in the order of a space-filling curve (see
+    // SpaceFillingCurveKeys()) instead of an unspecified order, such that the blocks of the
+    // influence coefficient matrix correspond to spatial clusters
+    bool space_filling_curve = false;
+
+    // Look the influence coefficients up in the influence kernel of the grid (see
+    // InfluenceKernelMatrix) by the grid indices of the points instead of evaluating the Green
+    // function at their coordinates, which are then not stored. The kernel needs O(N^2) memory. It
+    // does not apply to a hierarchical matrix.
+    bool kernel_lookup = false;
+
+    // Store and factorize the matrix H_I of the active set systems of the nonlinear solver in
+    // single precision, and refine their solutions iteratively to double precision. This halves
+    // the memory of H_I and speeds up its factorization; the solver falls back to double precision
+    // if H_I is too ill-conditioned, as long as the active set has at most n0 / sqrt(2) of the n0
+    // predicted points, such that the double precision H_I fits into the memory of a single
+    // precision H_I of all of them (and stops otherwise). It cannot be combined with a
+    // hierarchical matrix.
+    bool mixed_precision = false;
+
+    // Solve the nonlinear problem for an elastic estimate of the contact set within the predicted
+    // points (see EstimateContactSet()) instead of for all of them, which makes the influence
+    // coefficient matrix much smaller. If the solution penetrates the half space at predicted
+    // points outside of the estimate, they are added and the problem is solved again, such that the
+    // result is the same; the solve starts with all of them in the active set and extends the
+    // factorization of the previous solve. The largest predicted contact set then refers to the
+    // solved sets.
+    bool contact_set_estimate = false;
+
+    // If set, the statistics of the solver are added to it
+    SolverStatistics* statistics = nullptr;
+  };
+}  // namespace MIRCO
+
+#endif  // SRC_SOLVEROPTIONS_H_
@@ -0,0 +1,92 @@
+#include "mirco_timer.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "mirco_kokkostypes.h"
+
+namespace MIRCO
+{
+  void Timings::Add(const std::string& phase, const double seconds)
+  {
+    if (times_.count(phase) == 0) order_.push_back(phase);
+    times_[phase] += seconds;
+    ++calls_[phase];
+  }
+
+  double Timings::Get(const std::string& phase) const
+  {
+    const auto it = times_.find(phase);
+    return it == times_.end() ? 0.0 : it->second;
+  }
+
+  std::string Timings::Push(const std::string& phase)
+  {
+    const std::string path = running_.empty() ? phase : running_.back() + "/" + phase;
+    // Register the phase already now, such that it is printed before its nested phases
+    if (times_.count(path) == 0)
+    {
+      order_.push_back(path);
+      times_[path] = 0.0;
+      calls_[path] = 0;
+    }
+    running_.push_back(path);
+    return path;
+  }
+
+  void Timings::Pop() { running_.pop_back(); }
+
+  void Timings::Print(std::ostream& out) const
+  {
+    double topLevelTime = 0.0;
+    for (const auto& [phase, seconds] : times_)
+      if (phase.find('/') == std::string::npos) topLevelTime += seconds;
+
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+
+    out << "-- Timings --\n";
+    out << std::left << std::setw(40) << "Phase" << std::right << std::setw(14) << "Time [s]"
+        << std::setw(10) << "Share" << std::setw(10) << "Calls" << "\n";
+    for (const std::string& phase : order_)
+    {
+      const std::size_t separator = phase.rfind('/');
+      const int depth = std::count(phase.begin(), phase.end(), '/');
+      const std::string name =
+          separator == std::string::npos ? phase : phase.substr(separator + 1);
+      const double parentTime =
+          separator == std::string::npos ? topLevelTime : Get(phase.substr(0, separator));
+      const double seconds = Get(phase);
+      const double share = parentTime > 0.0 ? 100.0 * seconds / parentTime : 0.0;
+
+      out << std::string(2 * depth, ' ') << std::left << std::setw(40 - 2 * depth) << name
+          << std::right << std::fixed << std::setprecision(6) << std::setw(14) << seconds
+          << std::setprecision(1) << std::setw(8) << share << " %" << std::setw(10)
+          << calls_.at(phase) << "\n";
+    }
+    out << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+  ScopedTimer::ScopedTimer(Timings* timings, const std::string& phase)
+      : region_(phase), timings_(timings), phase_(phase)
+  {
+    if (!timings_) return;
+    Kokkos::fence();
+    phase_ = timings_->Push(phase);
+    start_ = std::chrono::steady_clock::now();
+  }
+
+  ScopedTimer::~ScopedTimer()
+  {
+    if (timings_)
+    {
+      Kokkos::fence();
+      const auto finish = std::chrono::steady_clock::now();
+      timings_->Pop();
+      timings_->Add(phase_, std::chrono::duration<double>(finish - start_).count());
+    }
+  }
+}  // namespace MIRCO
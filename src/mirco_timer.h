@@ -0,0 +1,109 @@
+#ifndef SRC_TIMER_H_
+#define SRC_TIMER_H_
+
+#include <Kokkos_Core.hpp>
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace MIRCO
+{
+  /**
+   * @brief Accumulated wall-clock times of the named phases of a computation
+   *
+   * Phases which are timed while another phase is running (see ScopedTimer) are nested into it:
+   * their name is prefixed with the name of the enclosing phase and a slash, e.g. "evaluate/nnls".
+   */
+  class Timings
+  {
+   public:
+    /**
+     * @brief Add a time to the total time of a phase
+     *
+     * @param[in] phase Name of the phase, including the names of the enclosing phases
+     * @param[in] seconds Wall-clock time [s]
+     */
+    void Add(const std::string& phase, const double seconds);
+
+    /**
+     * @brief Total time of a phase [s], which is 0 if the phase was never timed
+     */
+    double Get(const std::string& phase) const;
+
+    /**
+     * @brief Total times of all timed phases [s], ordered by name
+     */
+    const std::map<std::string, double>& Phases() const { return times_; }
+
+    /**
+     * @brief Start a phase nested into the currently running one
+     *
+     * @return Name of the phase, including the names of the enclosing phases
+     */
+    std::string Push(const std::string& phase);
+
+    /**
+     * @brief End the innermost running phase
+     */
+    void Pop();
+
+    /**
+     * @brief Print the hierarchical breakdown of the times, with the share of every phase of its
+     * enclosing phase and the number of times it was timed
+     */
+    void Print(std::ostream& out) const;
+
+   private:
+    std::map<std::string, double> times_;
+    std::map<std::string, int> calls_;
+    // Phases in the order in which they were first timed
+    std::vector<std::string> order_;
+    // Currently running phases, from the outermost to the innermost one
+    std::vector<std::string> running_;
+  };
+
+  /**
+   * @brief Mark a scope as a Kokkos profiling region, which is also ended if the scope is left by
+   * an exception
+   */
+  class ScopedRegion
+  {
+   public:
+    explicit ScopedRegion(const std::string& name) { Kokkos::Profiling::pushRegion(name); }
+    ~ScopedRegion() { Kokkos::Profiling::popRegion(); }
+
+    ScopedRegion(const ScopedRegion&) = delete;
+    ScopedRegion& operator=(const ScopedRegion&) = delete;
+  };
+
+  /**
+   * @brief Measure the wall-clock time of a scope and add it to a phase of the given timings. If
+   * timings is nullptr, nothing is measured.
+   *
+   * Kokkos kernels run asynchronously, so the default execution space is fenced at the beginning
+   * and at the end of the scope. Otherwise, the times of the kernels would be attributed to the
+   * phase which happens to wait for them. The fences are only done if the scope is timed.
+   *
+   * The scope is also marked as a Kokkos profiling region of the same name (also if timings is
+   * nullptr), such that external profiling tools attribute the kernels to it.
+   */
+  class ScopedTimer
+  {
+   public:
+    ScopedTimer(Timings* timings, const std::string& phase);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+   private:
+    ScopedRegion region_;
+    Timings* timings_;
+    std::string phase_;
+    std::chrono::steady_clock::time_point start_;
+  };
+}  // namespace MIRCO
+
+#endif  // SRC_TIMER_H_
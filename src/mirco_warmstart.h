@@ -17,8 +17,8 @@ namespace MIRCO
    * @return p0_d vector of contact forces predicted in the previous iteration but which are a part
    * of the currect predicted contact set (warmstart prediction)
    */
-  ViewVector_d Warmstart(
-      const ViewVectorInt_d& activeSet0, const ViewVectorInt_d& activeSetf, const ViewVector_d& pf);
+  ViewVector_d Warmstart(const ViewVectorGridIndex_d& activeSet0,
+      const ViewVectorGridIndex_d& activeSetf, const ViewVector_d& pf);
 }  // namespace MIRCO
 
 #endif  // SRC_WARMSTART_H_
@@ -0,0 +1,278 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../../src/mirco_contactpredictors.h"
+#include "../../src/mirco_hmatrix.h"
+#include "../../src/mirco_kokkostypes.h"
+#include "../../src/mirco_matrixsetup.h"
+#include "../../src/mirco_nonlinearsolver.h"
+#include "../../src/mirco_topology.h"
+#include "../../src/mirco_topologyutilities.h"
+#include "../../src/mirco_warmstart.h"
+
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+#include "../../src/mirco_exportvisualization.h"
+#endif
+
+namespace
+{
+  using namespace MIRCO;
+
+  // Element counts along one direction of the topologies Input/sup{2,5,6,7,8}.dat
+  const std::vector<int64_t> inputSizes = {5, 33, 65, 129, 257};
+
+  // Far-field displacements: the one of the framework tests, and a larger one for which roughly 10%
+  // of the points are predicted to be in contact
+  const std::vector<int64_t> deltas = {10, 30};
+
+  // Parameters of the framework tests
+  constexpr double LateralLength = 1000.0;
+  constexpr double CompositeYoungs = 1.0 / (2 * (1 - 0.3 * 0.3));
+
+  std::string TopologyFilePath(const int N)
+  {
+    const int resolution = std::lround(std::log2(N - 1));
+    return std::string(MIRCO_INPUT_DIR) + "/sup" + std::to_string(resolution) + ".dat";
+  }
+
+  // Contact set predicted in the first iteration (i.e. without elastic correction) for one of the
+  // topologies Input/sup*.dat
+  struct ContactProblem
+  {
+    ContactProblem(const int N, const double Delta) : N(N), GridSize(LateralLength / N)
+    {
+      const ViewMatrix_h topology_h = CreateSurfaceFromFile(TopologyFilePath(N));
+      topology = Kokkos::create_mirror_view_and_copy(ExecSpace_Default_t(), topology_h);
+      meshgrid = CreateMeshgrid(N, GridSize);
+      zmax = GetMax(topology);
+      ContactSetPredictor(activeSet0, xv0, yv0, b0, zmax, Delta, 0.0, topology, meshgrid);
+      n0 = activeSet0.extent(0);
+    }
+
+    int N;
+    double GridSize;
+    ViewMatrix_d topology;
+    ViewVector_d meshgrid;
+    double zmax;
+
+    int n0;
+    ViewVectorGridIndex_d activeSet0;
+    ViewVector_d xv0, yv0, b0;
+  };
+
+  benchmark::Counter Rate(const benchmark::State& state, const double itemsPerIteration)
+  {
+    return benchmark::Counter(state.iterations() * itemsPerIteration, benchmark::Counter::kIsRate);
+  }
+
+  void BM_SetupMatrix(benchmark::State& state)
+  {
+    const ContactProblem problem(state.range(0), state.range(1));
+    const bool PressureGreenFunFlag = state.range(2);
+    // Evaluate the Green function (0) or look the entries up in the influence kernel (1), which is
+    // set up once per grid
+    const bool kernelLookup = state.range(3);
+    const ViewMatrix_d kernel =
+        kernelLookup ? SetupInfluenceKernel(problem.N, problem.GridSize, CompositeYoungs,
+                           PressureGreenFunFlag)
+                     : ViewMatrix_d();
+
+    for (auto _ : state)
+    {
+      const ViewMatrix_d H = kernelLookup
+                                 ? SetupMatrix(problem.activeSet0, kernel)
+                                 : SetupMatrix(problem.xv0, problem.yv0, problem.GridSize,
+                                       CompositeYoungs, problem.n0, PressureGreenFunFlag);
+      Kokkos::fence();
+      benchmark::DoNotOptimize(H.data());
+    }
+
+    state.counters["n0"] = problem.n0;
+    state.counters["entries/s"] = Rate(state, static_cast<double>(problem.n0) * problem.n0);
+  }
+  BENCHMARK(BM_SetupMatrix)
+      ->ArgsProduct({inputSizes, deltas, {0, 1}, {0, 1}})
+      ->ArgNames({"N", "Delta", "PressureGreenFun", "KernelLookup"})
+      ->Unit(benchmark::kMillisecond);
+
+  void BM_NonlinearSolve(benchmark::State& state)
+  {
+    const ContactProblem problem(state.range(0), state.range(1));
+    // Stored matrix (0), its entries computed whenever they are needed (1), or an H-matrix (2)
+    const int matrixType = state.range(2);
+    const PointForceGreenFunction greenFunction(problem.GridSize, CompositeYoungs);
+    const ViewMatrix_d H = matrixType == 0 ? SetupMatrix(problem.xv0, problem.yv0, problem.GridSize,
+                                                 CompositeYoungs, problem.n0, false)
+                                           : ViewMatrix_d();
+    const OnTheFlyMatrix<PointForceGreenFunction> matrix(problem.xv0, problem.yv0, greenFunction);
+    const std::optional<HMatrix> hMatrix =
+        matrixType == 2 ? std::make_optional<HMatrix>(problem.xv0, problem.yv0, greenFunction, 1e-8)
+                        : std::nullopt;
+
+    double pivots = 0.0;
+    for (auto _ : state)
+    {
+      // The initial guess is overwritten by the solver
+      state.PauseTiming();
+      ViewVector_d p0("p0", problem.n0);
+      Kokkos::fence();
+      state.ResumeTiming();
+
+      ViewVector_d pf;
+      ViewVectorGridIndex_d activeSetf;
+      if (matrixType == 2)
+        pivots += nonlinearSolve(pf, activeSetf, p0, problem.activeSet0, *hMatrix, problem.b0);
+      else if (matrixType == 1)
+        pivots += nonlinearSolve(pf, activeSetf, p0, problem.activeSet0, matrix, problem.b0);
+      else
+        pivots += nonlinearSolve(pf, activeSetf, p0, problem.activeSet0, H, problem.b0);
+      Kokkos::fence();
+    }
+
+    state.counters["n0"] = problem.n0;
+    state.counters["pivots"] = benchmark::Counter(pivots, benchmark::Counter::kAvgIterations);
+    state.counters["pivots/s"] = benchmark::Counter(pivots, benchmark::Counter::kIsRate);
+    if (hMatrix)
+      state.counters["compression"] =
+          static_cast<double>(hMatrix->StoredValues()) / problem.n0 / problem.n0;
+  }
+  BENCHMARK(BM_NonlinearSolve)
+      ->ArgsProduct({inputSizes, deltas, {0, 1, 2}})
+      ->ArgNames({"N", "Delta", "Matrix"})
+      ->Unit(benchmark::kMillisecond);
+
+  void BM_ContactSetPredictor(benchmark::State& state)
+  {
+    const ContactProblem problem(state.range(0), state.range(1));
+    const double Delta = state.range(1);
+
+    for (auto _ : state)
+    {
+      ViewVectorGridIndex_d activeSet0;
+      ViewVector_d xv0, yv0, b0;
+      ContactSetPredictor(activeSet0, xv0, yv0, b0, problem.zmax, Delta, 0.0, problem.topology,
+          problem.meshgrid);
+      Kokkos::fence();
+      benchmark::DoNotOptimize(b0.data());
+    }
+
+    state.counters["n0"] = problem.n0;
+    state.counters["points/s"] = Rate(state, static_cast<double>(problem.N) * problem.N);
+  }
+  BENCHMARK(BM_ContactSetPredictor)
+      ->ArgsProduct({inputSizes, deltas})
+      ->ArgNames({"N", "Delta"})
+      ->Unit(benchmark::kMicrosecond);
+
+  void BM_Warmstart(benchmark::State& state)
+  {
+    const ContactProblem problem(state.range(0), state.range(1));
+
+    // Solution of the first iteration, which is used as the initial guess in the next one
+    ViewVector_d pf;
+    ViewVectorGridIndex_d activeSetf;
+    {
+      const ViewMatrix_d H = SetupMatrix(
+          problem.xv0, problem.yv0, problem.GridSize, CompositeYoungs, problem.n0, false);
+      ViewVector_d p0("p0", problem.n0);
+      nonlinearSolve(pf, activeSetf, p0, problem.activeSet0, H, problem.b0);
+    }
+
+    for (auto _ : state)
+    {
+      const ViewVector_d p0 = Warmstart(problem.activeSet0, activeSetf, pf);
+      Kokkos::fence();
+      benchmark::DoNotOptimize(p0.data());
+    }
+
+    state.counters["n0"] = problem.n0;
+    state.counters["points/s"] = Rate(state, problem.n0);
+  }
+  BENCHMARK(BM_Warmstart)
+      ->ArgsProduct({inputSizes, deltas})
+      ->ArgNames({"N", "Delta"})
+      ->Unit(benchmark::kMicrosecond);
+
+  void BM_CreateRmgSurface(benchmark::State& state)
+  {
+    const int resolution = state.range(0);
+    const int N = (1 << resolution) + 1;
+
+    for (auto _ : state)
+    {
+      // Parameters of Input/input_sup7.yaml
+      const ViewMatrix_h topology = CreateRmgSurface(resolution, 20.0, 0.7, false, 95);
+      benchmark::DoNotOptimize(topology.data());
+    }
+
+    state.counters["points/s"] = Rate(state, static_cast<double>(N) * N);
+  }
+  BENCHMARK(BM_CreateRmgSurface)
+      ->DenseRange(2, 8)
+      ->ArgName("Resolution")
+      ->Unit(benchmark::kMicrosecond);
+
+  void BM_CreateSurfaceFromFile(benchmark::State& state)
+  {
+    const int N = state.range(0);
+    const std::string filePath = TopologyFilePath(N);
+
+    for (auto _ : state)
+    {
+      const ViewMatrix_h topology = CreateSurfaceFromFile(filePath);
+      benchmark::DoNotOptimize(topology.data());
+    }
+
+    state.counters["points/s"] = Rate(state, static_cast<double>(N) * N);
+  }
+  BENCHMARK(BM_CreateSurfaceFromFile)
+      ->ArgsProduct({inputSizes})
+      ->ArgNames({"N"})
+      ->Unit(benchmark::kMicrosecond);
+
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+  void BM_ExportVisualization(benchmark::State& state)
+  {
+    const ContactProblem problem(state.range(0), deltas[0]);
+    const bool doublePrecision = state.range(1);
+    const int compressionLevel = state.range(2);
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "mirco_bench_exportvisualization").string();
+
+    // Same number of fields as in Evaluate()
+    const std::vector<ViewMatrix_d> fields(4, problem.topology);
+    const std::vector<std::string> fieldNames = {"Field 1", "Field 2", "Field 3", "Field 4"};
+
+    for (auto _ : state)
+    {
+      ExportVisualization(path, problem.GridSize, problem.activeSet0, fields, fieldNames,
+          doublePrecision, compressionLevel);
+    }
+    std::filesystem::remove(path + ".vti");
+
+    state.counters["points/s"] = Rate(state, static_cast<double>(problem.N) * problem.N);
+  }
+  BENCHMARK(BM_ExportVisualization)
+      ->ArgsProduct({inputSizes, {0, 1}, {0, 5}})
+      ->ArgNames({"N", "DoublePrecision", "CompressionLevel"})
+      ->Unit(benchmark::kMillisecond);
+#endif
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Kokkos::initialize(argc, argv);
+  {
+    benchmark::Initialize(&argc, argv);
+    if (!benchmark::ReportUnrecognizedArguments(argc, argv)) benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+  }
+  Kokkos::finalize();
+  return 0;
+}
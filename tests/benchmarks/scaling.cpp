@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/mirco_evaluate.h"
+#include "../../src/mirco_inputparameters.h"
+#include "../../src/mirco_kokkostypes.h"
+#include "../../src/mirco_timer.h"
+#include "../../src/mirco_topologyutilities.h"
+
+/*
+ * Strong and weak scaling driver for the whole Evaluate() pipeline.
+ *
+ * Kokkos cannot be initialized more than once per process, so every combination of case and
+ * thread count is run in a child process (this executable with --run), which prints the times of
+ * the solver phases. The parent collects them and writes a CSV file with the speedup and the
+ * parallel efficiency of every phase relative to the smallest thread count.
+ *
+ * The strong scaling cases (--cases) keep their size for all thread counts. The weak scaling cases
+ * (--weak) are random midpoint generator topologies whose resolution grows with the thread count,
+ * such that the grid points per thread stay about constant (see WeakScalingCase()).
+ *
+ * Usage: mirco_scaling [--threads=1,2,4,...] [--cases=sup5,...,rmg9] [--weak=rmg6,...]
+ *                      [--repetitions=3] [--output=scaling.csv]
+ */
+
+namespace
+{
+  using namespace MIRCO;
+
+  // Prefix of the lines of a child process which contain results
+  const std::string resultPrefix = "MIRCO_SCALING ";
+
+  const std::vector<std::string> defaultCases = {
+      "sup5", "sup6", "sup7", "sup8", "rmg6", "rmg7", "rmg8", "rmg9"};
+  const std::vector<std::string> defaultWeakCases = {"rmg6"};
+
+  std::vector<std::string> Split(const std::string& list)
+  {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    for (std::string item; std::getline(ss, item, ',');)
+      if (!item.empty()) items.push_back(item);
+    return items;
+  }
+
+  /**
+   * @brief Input parameters of a case: "supX" is the topology Input/supX.dat with the parameters of
+   * Input/input_sup5.yaml, and "rmgX" is a random midpoint generator topology of resolution X with
+   * the parameters of Input/input_sup7.yaml
+   */
+  InputParameters CreateCase(const std::string& name)
+  {
+    const std::string kind = name.substr(0, 3);
+    const int number = std::stoi(name.substr(3));
+    if (kind == "sup")
+    {
+      const std::string topologyFilePath =
+          std::string(MIRCO_INPUT_DIR) + "/sup" + std::to_string(number) + ".dat";
+      return InputParameters(1.0, 1.0, 0.3, 0.3, 0.01, 10.0, 1000.0, topologyFilePath, 100, true,
+          false);
+    }
+    if (kind == "rmg")
+      return InputParameters(
+          1.0, 1.0, 0.3, 0.3, 0.01, 10.0, 1000.0, number, 20.0, 0.7, 100, true, true, false, 95);
+    throw std::runtime_error("Unknown case: " + name);
+  }
+
+  /**
+   * @brief Case of a weak scaling sweep for the given thread count: the resolution of the random
+   * midpoint generator topology "rmgX" of the smallest thread count grows by one, i.e. the grid
+   * points about quadruple, for every fourfold thread count
+   */
+  std::string WeakScalingCase(const std::string& base, const int threads, const int minThreads)
+  {
+    if (base.compare(0, 3, "rmg") != 0)
+      throw std::runtime_error("Weak scaling needs a random topology (rmgX): " + base);
+    const int resolution =
+        std::stoi(base.substr(3)) +
+        static_cast<int>(std::lround(std::log(static_cast<double>(threads) / minThreads) /
+                                     std::log(4.0)));
+    return "rmg" + std::to_string(resolution);
+  }
+
+  /**
+   * @brief Child process: solve a case several times and print the times of the fastest run
+   */
+  int RunCase(int argc, char* argv[])
+  {
+    Kokkos::initialize(argc, argv);
+    {
+      const std::string name = argv[2];
+      const int repetitions = std::stoi(argv[3]);
+
+      InputParameters inputParams = CreateCase(name);
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+      const std::filesystem::path exportPath =
+          std::filesystem::temp_directory_path() / ("mirco_scaling_" + name);
+      inputParams.export_visualization_path = exportPath.string();
+#endif
+      const ViewVector_d meshgrid = CreateMeshgrid(inputParams.N, inputParams.grid_size);
+      const double zmax = GetMax(inputParams.topology);
+
+      std::optional<Timings> fastest;
+      for (int r = 0; r < repetitions; ++r)
+      {
+        Timings timings;
+        inputParams.solver_options.timings = &timings;
+
+        const auto start = std::chrono::steady_clock::now();
+        double meanPressure, effectiveContactAreaFraction;
+        Evaluate(meanPressure, effectiveContactAreaFraction, inputParams, zmax, meshgrid);
+        Kokkos::fence();
+        const auto finish = std::chrono::steady_clock::now();
+        timings.Add("total", std::chrono::duration<double>(finish - start).count());
+
+        if (!fastest || timings.Get("total") < fastest->Get("total")) fastest = timings;
+      }
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+      std::filesystem::remove(exportPath.string() + ".vti");
+#endif
+
+      std::cout << resultPrefix << "N " << inputParams.N << "\n";
+      for (const auto& [phase, seconds] : fastest->Phases())
+        std::cout << resultPrefix << phase << " " << seconds << "\n";
+    }
+    Kokkos::finalize();
+    return 0;
+  }
+
+  /**
+   * @brief Run a case with the given thread count in a child process
+   *
+   * @return N and the times of the phases
+   */
+  std::pair<int, std::map<std::string, double>> RunChild(const std::string& executable,
+      const std::string& name, const int threads, const int repetitions)
+  {
+    // OpenMP reads the variable, Kokkos::Threads the command line argument
+    setenv("OMP_NUM_THREADS", std::to_string(threads).c_str(), 1);
+    const std::string command = "\"" + executable + "\" --run " + name + " " +
+                                std::to_string(repetitions) +
+                                " --kokkos-num-threads=" + std::to_string(threads);
+
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) throw std::runtime_error("Cannot run: " + command);
+
+    int N = 0;
+    std::map<std::string, double> phases;
+    char buffer[1024];
+    while (fgets(buffer, sizeof(buffer), pipe))
+    {
+      const std::string line(buffer);
+      if (line.compare(0, resultPrefix.size(), resultPrefix) != 0) continue;
+
+      std::stringstream ss(line.substr(resultPrefix.size()));
+      std::string key;
+      double value;
+      ss >> key >> value;
+      if (key == "N")
+        N = static_cast<int>(value);
+      else
+        phases[key] = value;
+    }
+    if (pclose(pipe) != 0 || phases.count("total") == 0)
+      throw std::runtime_error("Failed to run: " + command);
+
+    return {N, phases};
+  }
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc >= 4 && std::string(argv[1]) == "--run") return RunCase(argc, argv);
+
+  std::vector<int> threadCounts;
+  std::vector<std::string> cases = defaultCases;
+  std::vector<std::string> weakCases = defaultWeakCases;
+  int repetitions = 3;
+  std::string output = "scaling.csv";
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string arg = argv[i];
+    const std::string value = arg.substr(arg.find('=') + 1);
+    if (arg.rfind("--threads=", 0) == 0)
+      for (const std::string& t : Split(value)) threadCounts.push_back(std::stoi(t));
+    else if (arg.rfind("--cases=", 0) == 0)
+      cases = Split(value);
+    else if (arg.rfind("--weak=", 0) == 0)
+      weakCases = Split(value);
+    else if (arg.rfind("--repetitions=", 0) == 0)
+      repetitions = std::stoi(value);
+    else if (arg.rfind("--output=", 0) == 0)
+      output = value;
+    else
+      throw std::runtime_error("Unknown argument: " + arg);
+  }
+  if (threadCounts.empty())
+  {
+    // Powers of two up to the number of hardware threads
+    const int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int t = 1; t <= maxThreads; t *= 2) threadCounts.push_back(t);
+  }
+  std::sort(threadCounts.begin(), threadCounts.end());
+
+  std::ofstream csv(output);
+  if (!csv) throw std::runtime_error("Cannot open output file: " + output);
+  csv << "scaling,case,N,threads,phase,time,speedup,efficiency\n";
+
+  for (const std::string& name : cases)
+  {
+    // Times of the smallest thread count, to which the speedups refer
+    std::map<std::string, double> reference;
+    for (const int threads : threadCounts)
+    {
+      const auto [N, phases] = RunChild(argv[0], name, threads, repetitions);
+      if (reference.empty()) reference = phases;
+
+      for (const auto& [phase, seconds] : phases)
+      {
+        const double speedup = reference[phase] / seconds;
+        const double efficiency = speedup * threadCounts.front() / threads;
+        csv << "strong," << name << "," << N << "," << threads << "," << phase << "," << seconds
+            << "," << speedup << "," << efficiency << "\n";
+      }
+      std::cout << name << " (N=" << N << ") with " << threads
+                << " threads: " << phases.at("total") << "s" << std::endl;
+    }
+  }
+
+  for (const std::string& base : weakCases)
+  {
+    // Times per grid point and thread of the smallest thread count. The grid points per thread are
+    // only approximately constant, so the efficiency refers to the time per grid point and thread.
+    std::map<std::string, double> reference;
+    for (const int threads : threadCounts)
+    {
+      const std::string name = WeakScalingCase(base, threads, threadCounts.front());
+      const auto [N, phases] = RunChild(argv[0], name, threads, repetitions);
+      const double pointsPerThread = static_cast<double>(N) * N / threads;
+      if (reference.empty())
+        for (const auto& [phase, seconds] : phases) reference[phase] = seconds / pointsPerThread;
+
+      for (const auto& [phase, seconds] : phases)
+      {
+        const double efficiency = reference[phase] * pointsPerThread / seconds;
+        const double speedup = efficiency * threads / threadCounts.front();
+        csv << "weak," << name << "," << N << "," << threads << "," << phase << "," << seconds
+            << "," << speedup << "," << efficiency << "\n";
+      }
+      std::cout << name << " (N=" << N << ", weak scaling of " << base << ") with " << threads
+                << " threads: " << phases.at("total") << "s" << std::endl;
+    }
+  }
+
+  std::cout << "Results written to " << output << std::endl;
+  return 0;
+}
@@ -1,19 +1,42 @@
 #include <gtest/gtest.h>
 #include <stdlib.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../src/mirco_contactpredictors.h"
+#include "../../src/mirco_flatindentor.h"
+#include "../../src/mirco_greenfunctions.h"
+#include "../../src/mirco_gridindexmap.h"
+#include "../../src/mirco_hmatrix.h"
+#include "../../src/mirco_influenceoperator.h"
 #include "../../src/mirco_inputparameters.h"
 #include "../../src/mirco_kokkostypes.h"
+#include "../../src/mirco_matrixsetup.h"
+#include "../../src/mirco_memory.h"
+#include "../../src/mirco_multilevel.h"
 #include "../../src/mirco_nonlinearsolver.h"
 #include "../../src/mirco_shapefactors.h"
+#include "../../src/mirco_timer.h"
 #include "../../src/mirco_topology.h"
+#include "../../src/mirco_topologyutilities.h"
 #include "../../src/mirco_utils.h"
 #include "../../src/mirco_warmstart.h"
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+#include "../../src/mirco_exportvisualization.h"
+#endif
 
 // Functors are sometimes necessary for device-side/offloaded compilation
 struct NonlinearSolverTest_primalvariable_1
 {
-  MIRCO::ViewVectorInt_d v_;
-  explicit NonlinearSolverTest_primalvariable_1(MIRCO::ViewVectorInt_d v) : v_(v) {}
+  MIRCO::ViewVectorGridIndex_d v_;
+  explicit NonlinearSolverTest_primalvariable_1(MIRCO::ViewVectorGridIndex_d v) : v_(v) {}
   KOKKOS_INLINE_FUNCTION
   void operator()(const int i) const { v_(i) = i; }
 };
@@ -139,11 +162,11 @@ TEST(NonlinearSolverTest, primalvariable)
   MIRCO::ViewVector_d b0_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), b0_h);
 
-  MIRCO::ViewVectorInt_d activeSet0_d("activeSet0_d", 9);
+  MIRCO::ViewVectorGridIndex_d activeSet0_d("activeSet0_d", 9);
   Kokkos::parallel_for(9, NonlinearSolverTest_primalvariable_1(activeSet0_d));
 
   MIRCO::ViewVector_d pf_d;
-  MIRCO::ViewVectorInt_d activeSetf_d;
+  MIRCO::ViewVectorGridIndex_d activeSetf_d;
 
   MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, matrix_d, b0_d);
 
@@ -160,6 +183,405 @@ TEST(NonlinearSolverTest, primalvariable)
   EXPECT_NEAR(p0_h(8), 149262.960807186, 1e-06);
 }
 
+// Points of a 20 x 20 grid, which are indented by a paraboloid, such that only some of them are
+// in contact and the influence coefficient matrix has low rank blocks
+struct NonlinearSolverTest_paraboloid
+{
+  static constexpr int N = 20;
+  static constexpr int n0 = N * N;
+  static constexpr double GridSize = 0.25;
+  MIRCO::ViewVector_d xv0_d, yv0_d;
+  MIRCO::ViewVectorGridIndex_d activeSet0_d;
+
+  NonlinearSolverTest_paraboloid() : activeSet0_d("activeSet0_d", n0)
+  {
+    MIRCO::ViewVector_h xv0_h("xv0_h", n0), yv0_h("yv0_h", n0);
+    for (int k = 0; k < n0; ++k)
+    {
+      xv0_h(k) = GridSize / 2 + (k / N) * GridSize;
+      yv0_h(k) = GridSize / 2 + (k % N) * GridSize;
+    }
+    xv0_d = Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), xv0_h);
+    yv0_d = Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), yv0_h);
+    Kokkos::parallel_for(n0, NonlinearSolverTest_primalvariable_1(activeSet0_d));
+  }
+
+  // Indentation of the points, shifted uniformly by shift
+  MIRCO::ViewVector_d Indentation(const double shift = 0.0) const
+  {
+    const auto xv0_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), xv0_d);
+    const auto yv0_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), yv0_d);
+    MIRCO::ViewVector_h b0_h("b0_h", n0);
+    for (int k = 0; k < n0; ++k)
+      b0_h(k) = 0.5 + shift -
+                ((xv0_h(k) - 2.5) * (xv0_h(k) - 2.5) + (yv0_h(k) - 2.5) * (yv0_h(k) - 2.5)) / 4;
+    return Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), b0_h);
+  }
+};
+
+template <typename MatrixType>
+struct NonlinearSolverTest_onthefly_1
+{
+  MIRCO::ViewMatrix_d H_;
+  MatrixType matrix_;
+  NonlinearSolverTest_onthefly_1(MIRCO::ViewMatrix_d H, MatrixType matrix) : H_(H), matrix_(matrix)
+  {
+  }
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int i) const
+  {
+    for (int j = 0; j < H_.extent_int(1); ++j) H_(i, j) = matrix_(i, j);
+  }
+};
+TEST(NonlinearSolverTest, onthefly)
+{
+  // Points of a 4 x 4 grid (with a gap), which are predicted to be in contact
+  const int n0 = 12;
+  const double GridSize = 0.25;
+  MIRCO::ViewVector_h xv0_h("xv0_h", n0), yv0_h("yv0_h", n0), b0_h("b0_h", n0);
+  for (int k = 0; k < n0; ++k)
+  {
+    const int a = k < 6 ? k : k + 4;
+    xv0_h(k) = GridSize / 2 + (a / 4) * GridSize;
+    yv0_h(k) = GridSize / 2 + (a % 4) * GridSize;
+    b0_h(k) = 1.0 + 0.5 * ((3 * k) % 5) - 0.3 * (k % 2);
+  }
+  MIRCO::ViewVector_d xv0_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), xv0_h);
+  MIRCO::ViewVector_d yv0_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), yv0_h);
+  MIRCO::ViewVector_d b0_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), b0_h);
+  MIRCO::ViewVectorGridIndex_d activeSet0_d("activeSet0_d", n0);
+  Kokkos::parallel_for(n0, NonlinearSolverTest_primalvariable_1(activeSet0_d));
+
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      const MIRCO::ViewMatrix_d H_d =
+          MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 1.5, n0, PressureGreenFunFlag);
+      const MIRCO::OnTheFlyMatrix<GreenFunction> matrix(
+          xv0_d, yv0_d, GreenFunction(GridSize, 1.5));
+
+      // The entries computed on the fly are the stored ones
+      MIRCO::ViewMatrix_d Hotf_d("Hotf_d", n0, n0);
+      Kokkos::parallel_for(n0, NonlinearSolverTest_onthefly_1<decltype(matrix)>(Hotf_d, matrix));
+      const auto H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), H_d);
+      const auto Hotf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), Hotf_d);
+      for (int i = 0; i < n0; ++i)
+        for (int j = 0; j < n0; ++j) EXPECT_EQ(Hotf_h(i, j), H_h(i, j));
+
+      // Hence, so is the solution
+      MIRCO::ViewVector_d p0_d("p0_d", n0), p0otf_d("p0otf_d", n0);
+      MIRCO::ViewVector_d pf_d, pfotf_d;
+      MIRCO::ViewVectorGridIndex_d activeSetf_d, activeSetfotf_d;
+      const int iterations =
+          MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, H_d, b0_d);
+      const int iterationsotf =
+          MIRCO::nonlinearSolve(pfotf_d, activeSetfotf_d, p0otf_d, activeSet0_d, matrix, b0_d);
+      EXPECT_EQ(iterationsotf, iterations);
+
+      const auto pf_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pf_d);
+      const auto pfotf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfotf_d);
+      const auto activeSetf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+      const auto activeSetfotf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfotf_d);
+      ASSERT_EQ(pfotf_h.extent(0), pf_h.extent(0));
+      EXPECT_GT(pf_h.extent(0), 0);
+      for (std::size_t i = 0; i < pf_h.extent(0); ++i)
+      {
+        EXPECT_EQ(activeSetfotf_h(i), activeSetf_h(i));
+        EXPECT_EQ(pfotf_h(i), pf_h(i));
+      }
+    });
+  }
+}
+
+TEST(NonlinearSolverTest, activecolumncache)
+{
+  // The active set grows beyond the columns which the cache of an OnTheFlyMatrix can hold next to
+  // H_I, but the solution remains the one of the stored matrix
+  const NonlinearSolverTest_paraboloid problem;
+  const int n0 = problem.n0;
+  const auto b0_d = problem.Indentation(3.0);
+  const MIRCO::PressureGreenFunction greenFunction(problem.GridSize, 1.5);
+  const MIRCO::ViewMatrix_d H_d =
+      MIRCO::SetupMatrix(problem.xv0_d, problem.yv0_d, greenFunction, n0);
+  const MIRCO::OnTheFlyMatrix<MIRCO::PressureGreenFunction> matrix(
+      problem.xv0_d, problem.yv0_d, greenFunction);
+
+  for (const bool mixedPrecision : {false, true})
+  {
+    MIRCO::ViewVector_d p0_d("p0_d", n0), p0otf_d("p0otf_d", n0);
+    MIRCO::ViewVector_d pf_d, pfotf_d;
+    MIRCO::ViewVectorGridIndex_d activeSetf_d, activeSetfotf_d;
+    const int iterations = MIRCO::nonlinearSolve(
+        pf_d, activeSetf_d, p0_d, problem.activeSet0_d, H_d, b0_d, mixedPrecision);
+    const int iterationsotf = MIRCO::nonlinearSolve(
+        pfotf_d, activeSetfotf_d, p0otf_d, problem.activeSet0_d, matrix, b0_d, mixedPrecision);
+    EXPECT_EQ(iterationsotf, iterations);
+
+    const auto pf_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pf_d);
+    const auto pfotf_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfotf_d);
+    const auto activeSetf_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+    const auto activeSetfotf_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfotf_d);
+    ASSERT_EQ(pfotf_h.extent(0), pf_h.extent(0));
+    EXPECT_GT(pf_h.extent(0), 3 * n0 / 4);
+    for (std::size_t i = 0; i < pf_h.extent(0); ++i)
+    {
+      EXPECT_EQ(activeSetfotf_h(i), activeSetf_h(i));
+      EXPECT_NEAR(pfotf_h(i), pf_h(i), 1e-12 * std::abs(pf_h(i)));
+    }
+  }
+}
+
+TEST(NonlinearSolverTest, hmatrix)
+{
+  // The H-matrix has low rank blocks, and only some of the points are in contact
+  const NonlinearSolverTest_paraboloid problem;
+  const int n0 = problem.n0;
+  const double GridSize = problem.GridSize;
+  const auto xv0_d = problem.xv0_d;
+  const auto yv0_d = problem.yv0_d;
+  const auto activeSet0_d = problem.activeSet0_d;
+  const auto b0_d = problem.Indentation();
+
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      const MIRCO::ViewMatrix_d H_d =
+          MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 1.5, n0, PressureGreenFunFlag);
+      const MIRCO::HMatrix matrix(xv0_d, yv0_d, GreenFunction(GridSize, 1.5), 1e-10, 16);
+      EXPECT_LT(matrix.StoredValues(), static_cast<std::size_t>(n0) * n0);
+
+      // The solution is the one of the dense matrix up to the tolerance
+      MIRCO::ViewVector_d p0_d("p0_d", n0), p0h_d("p0h_d", n0);
+      MIRCO::ViewVector_d pf_d, pfh_d;
+      MIRCO::ViewVectorGridIndex_d activeSetf_d, activeSetfh_d;
+      MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, H_d, b0_d);
+      MIRCO::nonlinearSolve(pfh_d, activeSetfh_d, p0h_d, activeSet0_d, matrix, b0_d);
+
+      const auto pf_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pf_d);
+      const auto pfh_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfh_d);
+      const auto activeSetf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+      const auto activeSetfh_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfh_d);
+      ASSERT_EQ(pfh_h.extent(0), pf_h.extent(0));
+      EXPECT_GT(pf_h.extent(0), 0);
+      EXPECT_LT(pf_h.extent(0), n0);
+
+      // The order of the final active sets depends on the order of the pivots
+      std::vector<double> p(n0, 0.0), ph(n0, 0.0);
+      double maxForce = 0.0;
+      for (std::size_t i = 0; i < pf_h.extent(0); ++i)
+      {
+        p[activeSetf_h(i)] = pf_h(i);
+        ph[activeSetfh_h(i)] = pfh_h(i);
+        maxForce = std::max(maxForce, pf_h(i));
+      }
+      for (int k = 0; k < n0; ++k) EXPECT_NEAR(ph[k], p[k], 1e-6 * maxForce);
+    });
+  }
+}
+
+TEST(NonlinearSolverTest, mixedprecision)
+{
+  const NonlinearSolverTest_paraboloid problem;
+  const int n0 = problem.n0;
+  const double GridSize = problem.GridSize;
+  const auto xv0_d = problem.xv0_d;
+  const auto yv0_d = problem.yv0_d;
+  const auto activeSet0_d = problem.activeSet0_d;
+  const auto b0_d = problem.Indentation();
+
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    const MIRCO::ViewMatrix_d H_d =
+        MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 1.5, n0, PressureGreenFunFlag);
+
+    // The iterative refinement recovers the solution in double precision
+    MIRCO::ViewVector_d p0_d("p0_d", n0), p0mp_d("p0mp_d", n0);
+    MIRCO::ViewVector_d pf_d, pfmp_d;
+    MIRCO::ViewVectorGridIndex_d activeSetf_d, activeSetfmp_d;
+    MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, H_d, b0_d);
+    MIRCO::nonlinearSolve(pfmp_d, activeSetfmp_d, p0mp_d, activeSet0_d, H_d, b0_d, true);
+
+    const auto pf_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pf_d);
+    const auto pfmp_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfmp_d);
+    const auto activeSetf_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+    const auto activeSetfmp_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfmp_d);
+    ASSERT_EQ(pfmp_h.extent(0), pf_h.extent(0));
+    EXPECT_GT(pf_h.extent(0), 1);
+
+    std::vector<double> p(n0, 0.0), pmp(n0, 0.0);
+    double maxForce = 0.0;
+    for (std::size_t i = 0; i < pf_h.extent(0); ++i)
+    {
+      p[activeSetf_h(i)] = pf_h(i);
+      pmp[activeSetfmp_h(i)] = pfmp_h(i);
+      maxForce = std::max(maxForce, pf_h(i));
+    }
+    for (int k = 0; k < n0; ++k) EXPECT_NEAR(pmp[k], p[k], 1e-12 * maxForce);
+  }
+}
+
+TEST(NonlinearSolverTest, closedform)
+{
+  const NonlinearSolverTest_paraboloid problem;
+  const int n0 = problem.n0;
+  const double GridSize = problem.GridSize;
+  const double CompositeYoungs = 1.5;
+  const double smallShift = 1e-3;
+  const double largeShift = 0.3;
+  const auto xv0_d = problem.xv0_d;
+  const auto yv0_d = problem.yv0_d;
+  const auto activeSet0_d = problem.activeSet0_d;
+  const auto b0_d = problem.Indentation();
+  const auto b0Small_d = problem.Indentation(smallShift);
+  const auto b0Large_d = problem.Indentation(largeShift);
+
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      const GreenFunction greenFunction(GridSize, CompositeYoungs);
+      const MIRCO::ViewMatrix_d H_d =
+          MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, CompositeYoungs, n0, PressureGreenFunFlag);
+
+      MIRCO::ViewVector_d p0_d("p0_d", n0), p0Small_d("p0Small_d", n0);
+      MIRCO::ViewVector_d pf_d, pfSmall_d;
+      MIRCO::ViewVectorGridIndex_d activeSetf_d, activeSetfSmall_d;
+      MIRCO::NonlinearSolverState state;
+      MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, H_d, b0_d, false, &state);
+      MIRCO::ViewVector_d z_d;
+      ASSERT_TRUE(MIRCO::UniformIndentationResponse(z_d, state, greenFunction(0.0, 0.0)));
+      ASSERT_EQ(z_d.extent(0), activeSetf_d.extent(0));
+
+      // Without a factorization of H_I, e.g. after a solve in single precision, there is no
+      // response
+      MIRCO::NonlinearSolverState mixedPrecisionState;
+      MIRCO::ViewVector_d pfMixed_d, p0Mixed_d("p0Mixed_d", n0), zMixed_d;
+      MIRCO::ViewVectorGridIndex_d activeSetfMixed_d;
+      MIRCO::nonlinearSolve(pfMixed_d, activeSetfMixed_d, p0Mixed_d, activeSet0_d, H_d, b0_d, true,
+          &mixedPrecisionState);
+      EXPECT_FALSE(MIRCO::UniformIndentationResponse(
+          zMixed_d, mixedPrecisionState, greenFunction(0.0, 0.0)));
+
+      // A large shift brings further points into contact
+      const MIRCO::OnTheFlyMatrix<GreenFunction> matrix(xv0_d, yv0_d, greenFunction);
+      MIRCO::ViewVector_d pfLarge_d = pf_d;
+      EXPECT_FALSE(MIRCO::ShiftActiveSetSolution(
+          pfLarge_d, activeSetf_d, z_d, largeShift, activeSet0_d, matrix, b0Large_d));
+      EXPECT_EQ(pfLarge_d.data(), pf_d.data());
+
+      // A small shift keeps the active set, and the closed form is the solution of the nonlinear
+      // solver
+      MIRCO::ViewVector_d pfShifted_d = pf_d;
+      ASSERT_TRUE(MIRCO::ShiftActiveSetSolution(
+          pfShifted_d, activeSetf_d, z_d, smallShift, activeSet0_d, matrix, b0Small_d));
+      MIRCO::nonlinearSolve(pfSmall_d, activeSetfSmall_d, p0Small_d, activeSet0_d, H_d, b0Small_d);
+
+      const auto pfShifted_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfShifted_d);
+      const auto pfSmall_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfSmall_d);
+      const auto activeSetf_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+      const auto activeSetfSmall_h =
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfSmall_d);
+      ASSERT_EQ(pfSmall_h.extent(0), pfShifted_h.extent(0));
+
+      std::vector<double> p(n0, 0.0), pShifted(n0, 0.0);
+      for (std::size_t i = 0; i < pfSmall_h.extent(0); ++i)
+      {
+        p[activeSetfSmall_h(i)] = pfSmall_h(i);
+        pShifted[activeSetf_h(i)] = pfShifted_h(i);
+      }
+      for (int k = 0; k < n0; ++k) EXPECT_NEAR(pShifted[k], p[k], 1e-10);
+    });
+  }
+}
+
+TEST(NonlinearSolverTest, restart)
+{
+  // The paraboloid indents the points slightly more the second time, which keeps the active set
+  const NonlinearSolverTest_paraboloid problem;
+  const int n0 = problem.n0;
+  const double GridSize = problem.GridSize;
+  const double nnlstol = 1e-8;
+  const auto xv0_d = problem.xv0_d;
+  const auto yv0_d = problem.yv0_d;
+  const auto activeSet0_d = problem.activeSet0_d;
+  const auto b0_d = problem.Indentation();
+  const auto b0Shifted_d = problem.Indentation(1e-3);
+  const MIRCO::ViewMatrix_d H_d = MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 1.5, n0, true);
+
+  MIRCO::NonlinearSolverState state;
+  MIRCO::ViewVector_d p0_d("p0_d", n0);
+  MIRCO::ViewVector_d pf_d;
+  MIRCO::ViewVectorGridIndex_d activeSetf_d;
+  MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, H_d, b0_d, false, &state);
+  EXPECT_EQ(state.activeSet.data(), activeSetf_d.data());
+  EXPECT_EQ(state.factorization.extent(0), activeSetf_d.extent(0));
+  EXPECT_GT(state.factorization.extent(0), 1);
+
+  // The restart from the previous solution solves its active set system with the stored
+  // factorization, which is the solution
+  MIRCO::ViewVector_d p0Restart_d = MIRCO::Warmstart(activeSet0_d, activeSetf_d, pf_d);
+  MIRCO::ViewVector_d pfRestart_d;
+  MIRCO::ViewVectorGridIndex_d activeSetfRestart_d;
+  const int restartIterations = MIRCO::nonlinearSolve(pfRestart_d, activeSetfRestart_d,
+      p0Restart_d, activeSet0_d, H_d, b0Shifted_d, false, &state);
+  EXPECT_EQ(restartIterations, 1);
+
+  MIRCO::ViewVector_d p0Cold_d("p0Cold_d", n0);
+  MIRCO::ViewVector_d pfCold_d;
+  MIRCO::ViewVectorGridIndex_d activeSetfCold_d;
+  const int coldIterations = MIRCO::nonlinearSolve(
+      pfCold_d, activeSetfCold_d, p0Cold_d, activeSet0_d, H_d, b0Shifted_d);
+  EXPECT_GT(coldIterations, restartIterations);
+
+  const auto pfRestart_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfRestart_d);
+  const auto pfCold_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfCold_d);
+  const auto activeSetfRestart_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfRestart_d);
+  const auto activeSetfCold_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfCold_d);
+  ASSERT_EQ(pfRestart_h.extent(0), pfCold_h.extent(0));
+
+  std::vector<double> p(n0, 0.0), pCold(n0, 0.0);
+  for (std::size_t i = 0; i < pfCold_h.extent(0); ++i)
+  {
+    p[activeSetfRestart_h(i)] = pfRestart_h(i);
+    pCold[activeSetfCold_h(i)] = pfCold_h(i);
+  }
+  for (int k = 0; k < n0; ++k) EXPECT_NEAR(p[k], pCold[k], 1e-10);
+
+  // The restarted solution closes the gaps of the points in contact and opens all others
+  const auto H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), H_d);
+  const auto b0Shifted_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), b0Shifted_d);
+  for (int k = 0; k < n0; ++k)
+  {
+    double w = -b0Shifted_h(k);
+    for (int l = 0; l < n0; ++l) w += H_h(k, l) * p[l];
+    EXPECT_GE(w, -nnlstol);
+    if (p[k] > 0) EXPECT_NEAR(w, 0.0, 1e-10);
+  }
+}
+
 TEST(FilesystemUtils, createrelativepath)
 {
   std::string targetfilename = "input.dat";
@@ -302,8 +724,8 @@ TEST(inputParameters, directInput_dat)
 
 TEST(warmstarting, warmstart)
 {
-  MIRCO::ViewVectorInt_h activeSet0_h("activeSet0_h", 3);
-  MIRCO::ViewVectorInt_h activeSetf_h("activeSetf_h", 2);
+  MIRCO::ViewVectorGridIndex_h activeSet0_h("activeSet0_h", 3);
+  MIRCO::ViewVectorGridIndex_h activeSetf_h("activeSetf_h", 2);
   MIRCO::ViewVector_h pf_h("", 2);
 
   activeSet0_h(0) = 12;
@@ -316,9 +738,9 @@ TEST(warmstarting, warmstart)
   pf_h(0) = 10;
   pf_h(1) = 30;
 
-  MIRCO::ViewVectorInt_d activeSet0_d =
+  MIRCO::ViewVectorGridIndex_d activeSet0_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), activeSet0_h);
-  MIRCO::ViewVectorInt_d activeSetf_d =
+  MIRCO::ViewVectorGridIndex_d activeSetf_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), activeSetf_h);
   MIRCO::ViewVector_d pf_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), pf_h);
@@ -333,8 +755,8 @@ TEST(warmstarting, warmstart)
 
 TEST(warmstarting, warmstart2)
 {
-  MIRCO::ViewVectorInt_h activeSet0_h("activeSet0_h", 3);
-  MIRCO::ViewVectorInt_h activeSetf_h("activeSetf_h", 4);
+  MIRCO::ViewVectorGridIndex_h activeSet0_h("activeSet0_h", 3);
+  MIRCO::ViewVectorGridIndex_h activeSetf_h("activeSetf_h", 4);
   MIRCO::ViewVector_h pf_h("", 4);
 
   activeSet0_h(0) = 12;
@@ -351,9 +773,9 @@ TEST(warmstarting, warmstart2)
   pf_h(2) = 70;
   pf_h(3) = 30;
 
-  MIRCO::ViewVectorInt_d activeSet0_d =
+  MIRCO::ViewVectorGridIndex_d activeSet0_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), activeSet0_h);
-  MIRCO::ViewVectorInt_d activeSetf_d =
+  MIRCO::ViewVectorGridIndex_d activeSetf_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), activeSetf_h);
   MIRCO::ViewVector_d pf_d =
       Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), pf_h);
@@ -391,6 +813,974 @@ TEST(shapefactors, check)
   }
 }
 
+TEST(shapefactors, compute)
+{
+  // The matrix-free flat indentor solve has to reproduce the tabulated shape factors
+  for (const int N : {1, 5, 17})
+  {
+    EXPECT_NEAR(MIRCO::getShapeFactor(N, true), MIRCO::ComputeShapeFactor(N, true), 1e-12);
+    EXPECT_NEAR(MIRCO::getShapeFactor(N, false), MIRCO::ComputeShapeFactor(N, false), 1e-12);
+  }
+}
+
+TEST(shapefactors, computeConcurrently)
+{
+  const std::vector<int> Ns{2, 3, 5, 9, 17};
+  std::map<int, double> results;
+  MIRCO::ComputeShapeFactors(
+      Ns, true, [&](const int N, const double shapeFactor) { results[N] = shapeFactor; }, 1e-13, 2);
+
+  ASSERT_EQ(results.size(), Ns.size());
+  for (const int N : Ns) EXPECT_NEAR(results[N], MIRCO::getShapeFactor(N, true), 1e-12);
+}
+
+TEST(shapefactors, cache)
+{
+  // Shape factors beyond the tables are read from the cache file if available
+  const std::string cacheFile = "test_shapefactors_cache.dat";
+  {
+    std::ofstream file(cacheFile);
+    file << "100000 1 0.5\n100000 0 0.25\n";
+  }
+  setenv("MIRCO_SHAPE_FACTOR_CACHE", cacheFile.c_str(), 1);
+
+  EXPECT_EQ(MIRCO::getShapeFactor(100000, true), 0.5);
+  EXPECT_EQ(MIRCO::getShapeFactor(100000, false), 0.25);
+
+  unsetenv("MIRCO_SHAPE_FACTOR_CACHE");
+  std::remove(cacheFile.c_str());
+}
+
+TEST(greenfunctions, elementaryfunctions)
+{
+  // The vectorizable logarithm and arcsine agree with the standard library up to rounding
+  constexpr double eps = std::numeric_limits<double>::epsilon();
+  std::vector<double> logArguments, asinArguments;
+  for (int k = -400; k <= 400; ++k) logArguments.push_back(std::pow(10.0, k / 40.0) * 1.2345);
+  for (int k = 0; k <= 1000; ++k) asinArguments.push_back(k / 1000.0);
+  for (const double x : logArguments)
+    EXPECT_NEAR(MIRCO::Impl::Log(x), std::log(x), eps * std::abs(std::log(x)) + eps);
+  for (const double x : asinArguments)
+    EXPECT_NEAR(MIRCO::Impl::Asin(x), std::asin(x), 2 * eps * std::asin(x));
+
+#if KOKKOS_VERSION >= 40000
+  // SIMD vectors give the scalar results in every lane
+  using simd_t = Kokkos::Experimental::native_simd<double>;
+  constexpr int width = simd_t::size();
+  for (const std::vector<double>* arguments : {&logArguments, &asinArguments})
+  {
+    for (int i0 = 0; i0 + width <= static_cast<int>(arguments->size()); i0 += width)
+    {
+      const simd_t x([&](const std::size_t lane) { return (*arguments)[i0 + lane]; });
+      const simd_t values =
+          arguments == &logArguments ? MIRCO::Impl::Log(x) : MIRCO::Impl::Asin(x);
+      for (int lane = 0; lane < width; ++lane)
+        EXPECT_EQ(values[lane], arguments == &logArguments
+                                    ? MIRCO::Impl::Log((*arguments)[i0 + lane])
+                                    : MIRCO::Impl::Asin((*arguments)[i0 + lane]));
+    }
+  }
+#endif
+}
+
+TEST(matrixsetup, entries)
+{
+  // The vectorized kernels have to reproduce the scalar entries, also for the remainder of a SIMD
+  // vector
+  const int N = 5;
+  const int N2 = N * N;
+  const double GridSize = 0.3;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::ViewVector_h xv0_h("xv0_h", N2);
+    MIRCO::ViewVector_h yv0_h("yv0_h", N2);
+    for (int a = 0; a < N2; ++a)
+    {
+      xv0_h(a) = (a / N) * GridSize;
+      yv0_h(a) = (a % N) * GridSize;
+    }
+    MIRCO::ViewVector_d xv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), xv0_h);
+    MIRCO::ViewVector_d yv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), yv0_h);
+
+    MIRCO::ViewMatrix_h H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 2.0, N2, PressureGreenFunFlag));
+    for (int a = 0; a < N2; ++a)
+      for (int b = 0; b < N2; ++b)
+        EXPECT_EQ(H_h(a, b), MIRCO::SetupMatrixOneEntry(a / N, a % N, b / N, b % N, GridSize, 2.0,
+                                 N, PressureGreenFunFlag));
+
+    MIRCO::ViewMatrix_h kernel_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::SetupInfluenceKernel(N, GridSize, 2.0, PressureGreenFunFlag));
+    for (int a = 0; a < N; ++a)
+      for (int b = 0; b < N; ++b)
+        EXPECT_EQ(kernel_h(a, b),
+            MIRCO::SetupMatrixOneEntry(a, b, 0, 0, GridSize, 2.0, N, PressureGreenFunFlag));
+  }
+}
+
+TEST(matrixsetup, farfield)
+{
+  // The far-field approximation has to be within the tolerance, and exact within the near-field
+  // radius
+  const int N = 33;
+  const double GridSize = 0.3;
+  const double FarFieldTolerance = 1e-8;
+  const double NearFieldRadius = 12.0;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      const GreenFunction exactGreenFunction(GridSize, 2.0);
+      const GreenFunction greenFunction(GridSize, 2.0, FarFieldTolerance, NearFieldRadius);
+      MIRCO::ViewMatrix_h kernel_h = Kokkos::create_mirror_view_and_copy(
+          MIRCO::MemorySpace_Host_t(), MIRCO::SetupInfluenceKernel(N, greenFunction));
+      for (int a = 0; a < N; ++a)
+        for (int b = 0; b < N; ++b)
+        {
+          const double exact = MIRCO::SetupMatrixOneEntry(a, b, 0, 0, exactGreenFunction);
+          const double approximation = MIRCO::SetupMatrixOneEntry(a, b, 0, 0, greenFunction);
+          EXPECT_EQ(kernel_h(a, b), approximation);
+          EXPECT_NEAR(approximation, exact, FarFieldTolerance * exact);
+          if (a * a + b * b <= NearFieldRadius * NearFieldRadius) EXPECT_EQ(approximation, exact);
+        }
+
+      // The runtime selection gives the same entries
+      EXPECT_EQ(MIRCO::SetupMatrixOneEntry(7, 3, 0, 0, GridSize, 2.0, N, PressureGreenFunFlag,
+                    FarFieldTolerance, NearFieldRadius),
+          MIRCO::SetupMatrixOneEntry(7, 3, 0, 0, greenFunction));
+    });
+  }
+}
+
+TEST(matrixsetup, update)
+{
+  // The matrix updated from the one of another set of points has to be the assembled one
+  const int N = 6;
+  const double GridSize = 0.3;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    // Grid points with a < 24, and the ones with 12 <= a < 36 in reverse order
+    const int n0 = 24;
+    MIRCO::ViewVectorGridIndex_h previousActiveSet_h("previousActiveSet_h", n0);
+    MIRCO::ViewVectorGridIndex_h activeSet0_h("activeSet0_h", n0);
+    MIRCO::ViewVector_h previousxv0_h("previousxv0_h", n0), previousyv0_h("previousyv0_h", n0);
+    MIRCO::ViewVector_h xv0_h("xv0_h", n0), yv0_h("yv0_h", n0);
+    for (int k = 0; k < n0; ++k)
+    {
+      previousActiveSet_h(k) = k;
+      activeSet0_h(k) = 35 - k;
+      previousxv0_h(k) = (previousActiveSet_h(k) / N) * GridSize;
+      previousyv0_h(k) = (previousActiveSet_h(k) % N) * GridSize;
+      xv0_h(k) = (activeSet0_h(k) / N) * GridSize;
+      yv0_h(k) = (activeSet0_h(k) % N) * GridSize;
+    }
+    const auto toDevice = [](const auto view_h) {
+      return Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), view_h);
+    };
+
+    std::size_t reusedEntries = 0;
+    const MIRCO::ViewMatrix_d H_d = MIRCO::SetupMatrix(
+        toDevice(xv0_h), toDevice(yv0_h), GridSize, 2.0, n0, PressureGreenFunFlag);
+    const MIRCO::ViewMatrix_d Hupdated_d =
+        MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+          using GreenFunction = typename decltype(tag)::type;
+          const GreenFunction greenFunction(GridSize, 2.0);
+          const MIRCO::ViewMatrix_d previousH_d = MIRCO::SetupMatrix(
+              toDevice(previousxv0_h), toDevice(previousyv0_h), greenFunction, n0);
+          return MIRCO::UpdateMatrix(previousH_d, toDevice(previousActiveSet_h),
+              toDevice(activeSet0_h), toDevice(xv0_h), toDevice(yv0_h), greenFunction,
+              reusedEntries);
+        });
+    EXPECT_EQ(reusedEntries, 12 * 12);
+
+    const auto H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), H_d);
+    const auto Hupdated_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), Hupdated_d);
+    for (int i = 0; i < n0; ++i)
+      for (int j = 0; j < n0; ++j) EXPECT_EQ(Hupdated_h(i, j), H_h(i, j));
+  }
+}
+
+TEST(matrixsetup, kernellookup)
+{
+  // The matrix looked up in the influence kernel by the grid indices has to be the one evaluated at
+  // the coordinates of the points, up to the rounding of their offsets
+  const int N = 6;
+  const double GridSize = 0.3;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    // Every third grid point, in reverse order
+    const int n0 = 12;
+    MIRCO::ViewVectorGridIndex_h activeSet0_h("activeSet0_h", n0);
+    MIRCO::ViewVector_h xv0_h("xv0_h", n0), yv0_h("yv0_h", n0);
+    for (int k = 0; k < n0; ++k)
+    {
+      activeSet0_h(k) = 35 - 3 * k;
+      xv0_h(k) = (activeSet0_h(k) / N) * GridSize;
+      yv0_h(k) = (activeSet0_h(k) % N) * GridSize;
+    }
+    const auto toDevice = [](const auto view_h) {
+      return Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), view_h);
+    };
+
+    const MIRCO::ViewMatrix_d H_d = MIRCO::SetupMatrix(
+        toDevice(xv0_h), toDevice(yv0_h), GridSize, 2.0, n0, PressureGreenFunFlag);
+    const MIRCO::ViewMatrix_d kernel_d =
+        MIRCO::SetupInfluenceKernel(N, GridSize, 2.0, PressureGreenFunFlag);
+    const MIRCO::ViewMatrix_d Hlookup_d = MIRCO::SetupMatrix(toDevice(activeSet0_h), kernel_d);
+
+    const auto H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), H_d);
+    const auto Hlookup_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), Hlookup_d);
+    ASSERT_EQ(Hlookup_h.extent(0), n0);
+    for (int i = 0; i < n0; ++i)
+      for (int j = 0; j < n0; ++j)
+        EXPECT_NEAR(Hlookup_h(i, j), H_h(i, j), 1e-12 * std::abs(H_h(i, i)));
+  }
+}
+
+TEST(influenceoperator, apply)
+{
+  // The FFT based operator has to reproduce the product with the dense influence coefficient matrix
+  const int N = 7;
+  const int N2 = N * N;
+  const double GridSize = 0.3;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::ViewVector_h xv0_h("xv0_h", N2);
+    MIRCO::ViewVector_h yv0_h("yv0_h", N2);
+    MIRCO::ViewVector_h p_h("p_h", N2);
+    for (int a = 0; a < N2; ++a)
+    {
+      xv0_h(a) = (a / N) * GridSize;
+      yv0_h(a) = (a % N) * GridSize;
+      p_h(a) = 1.0 + 0.1 * a;
+    }
+    MIRCO::ViewVector_d xv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), xv0_h);
+    MIRCO::ViewVector_d yv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), yv0_h);
+    MIRCO::ViewVector_d p_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), p_h);
+
+    MIRCO::ViewMatrix_h H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 2.0, N2, PressureGreenFunFlag));
+
+    MIRCO::ViewVector_d u_d("u_d", N2);
+    MIRCO::InfluenceOperator H(N, GridSize, 2.0, PressureGreenFunFlag);
+    H.Apply(u_d, p_d);
+    MIRCO::ViewVector_h u_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), u_d);
+
+    for (int i = 0; i < N2; ++i)
+    {
+      double expected = 0.0;
+      for (int j = 0; j < N2; ++j) expected += H_h(i, j) * p_h(j);
+      EXPECT_NEAR(u_h(i), expected, 1e-12 * std::abs(expected));
+    }
+  }
+}
+
+TEST(influenceoperator, displacementfield)
+{
+  const int N = 6;
+  const double GridSize = 0.5;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::ViewMatrix_h p_h("p_h", N, N);
+    for (int i = 0; i < N; ++i)
+      for (int j = 0; j < N; ++j) p_h(i, j) = (i + 2 * j) % 3;
+    MIRCO::ViewMatrix_d p_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), p_h);
+
+    MIRCO::ViewMatrix_h u_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::ComputeDisplacementField(p_d, GridSize, 1.5, PressureGreenFunFlag));
+
+    for (int ix = 0; ix < N; ++ix)
+    {
+      for (int iy = 0; iy < N; ++iy)
+      {
+        double expected = 0.0;
+        for (int jx = 0; jx < N; ++jx)
+          for (int jy = 0; jy < N; ++jy)
+            expected += MIRCO::SetupMatrixOneEntry(
+                            ix, iy, jx, jy, GridSize, 1.5, N, PressureGreenFunFlag) *
+                        p_h(jx, jy);
+        EXPECT_NEAR(u_h(ix, iy), expected, 1e-12 * std::abs(expected));
+      }
+    }
+  }
+}
+
+TEST(hmatrix, apply)
+{
+  // The product with the H-matrix has to approximate the one with the dense matrix
+  const int N = 24;
+  const int N2 = N * N;
+  const double GridSize = 0.3;
+  for (const bool PressureGreenFunFlag : {true, false})
+  {
+    MIRCO::ViewVector_h xv0_h("xv0_h", N2);
+    MIRCO::ViewVector_h yv0_h("yv0_h", N2);
+    MIRCO::ViewVector_h p_h("p_h", N2);
+    for (int a = 0; a < N2; ++a)
+    {
+      xv0_h(a) = (a / N) * GridSize;
+      yv0_h(a) = (a % N) * GridSize;
+      p_h(a) = 1.0 + std::sin(a);
+    }
+    MIRCO::ViewVector_d xv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), xv0_h);
+    MIRCO::ViewVector_d yv0_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), yv0_h);
+    MIRCO::ViewVector_d p_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), p_h);
+
+    const MIRCO::ViewMatrix_h H_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::SetupMatrix(xv0_d, yv0_d, GridSize, 2.0, N2, PressureGreenFunFlag));
+    MIRCO::ViewVector_d u_d("u_d", N2);
+    MIRCO::DispatchGreenFunction(PressureGreenFunFlag, [&](auto tag) {
+      using GreenFunction = typename decltype(tag)::type;
+      const MIRCO::HMatrix matrix(xv0_d, yv0_d, GreenFunction(GridSize, 2.0), 1e-8, 16);
+      EXPECT_LT(matrix.StoredValues(), static_cast<std::size_t>(N2) * N2);
+      matrix.Apply(u_d, p_d);
+    });
+    const MIRCO::ViewVector_h u_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), u_d);
+
+    for (int a = 0; a < N2; ++a)
+    {
+      double expected = 0.0;
+      for (int b = 0; b < N2; ++b) expected += H_h(a, b) * p_h(b);
+      EXPECT_NEAR(u_h(a), expected, 1e-7 * expected);
+    }
+  }
+}
+
+TEST(hmatrix, preconditioner)
+{
+  // Updating the preconditioner only factorizes the blocks whose points changed, and gives the
+  // same result as a new one
+  const int N = 24;
+  const int N2 = N * N;
+  const double GridSize = 0.3;
+  MIRCO::ViewVector_h xv0_h("xv0_h", N2);
+  MIRCO::ViewVector_h yv0_h("yv0_h", N2);
+  for (int a = 0; a < N2; ++a)
+  {
+    xv0_h(a) = (a / N) * GridSize;
+    yv0_h(a) = (a % N) * GridSize;
+  }
+  MIRCO::ViewVector_d xv0_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), xv0_h);
+  MIRCO::ViewVector_d yv0_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), yv0_h);
+  const MIRCO::HMatrix matrix(
+      xv0_d, yv0_d, MIRCO::PressureGreenFunction(GridSize, 2.0), 1e-8, 16);
+
+  // Every other point, then the same points in reverse order, then all but the last one
+  const int n = N2 / 2;
+  MIRCO::ViewVectorInt_h indices_h("indices_h", n);
+  for (int i = 0; i < n; ++i) indices_h(i) = 2 * i;
+  MIRCO::ViewVectorInt_d indices_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), indices_h);
+  MIRCO::HMatrix::Preconditioner preconditioner(matrix);
+  EXPECT_GT(preconditioner.Update(indices_d, n), 1);
+  EXPECT_EQ(preconditioner.Update(indices_d, n), 0);
+  for (int i = 0; i < n; ++i) indices_h(i) = 2 * (n - 1 - i);
+  Kokkos::deep_copy(indices_d, indices_h);
+  EXPECT_EQ(preconditioner.Update(indices_d, n), 0);
+  EXPECT_EQ(preconditioner.Update(indices_d, n - 1), 1);
+
+  MIRCO::HMatrix::Preconditioner newPreconditioner(matrix);
+  newPreconditioner.Update(indices_d, n - 1);
+  MIRCO::ViewVector_h r_h("r_h", n - 1);
+  for (int i = 0; i < n - 1; ++i) r_h(i) = 1.0 + std::sin(i);
+  MIRCO::ViewVector_d r_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), r_h);
+  MIRCO::ViewVector_d z_d("z_d", n - 1);
+  MIRCO::ViewVector_d expected_d("expected_d", n - 1);
+  preconditioner.Apply(z_d, r_d);
+  newPreconditioner.Apply(expected_d, r_d);
+  const auto z_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), z_d);
+  const auto expected_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), expected_d);
+  for (int i = 0; i < n - 1; ++i) EXPECT_EQ(z_h(i), expected_h(i));
+}
+
+TEST(contactpredictor, spacefillingcurve)
+{
+  for (const int N : {8, 5})
+  {
+    // The curve visits every grid point once, and consecutive points are neighbours if it fills
+    // the grid completely
+    MIRCO::ViewVectorGridIndex_h points_h("points_h", N * N);
+    for (int a = 0; a < N * N; ++a) points_h(a) = a;
+    const auto keys_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(),
+        MIRCO::SpaceFillingCurveKeys(
+            Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), points_h), N));
+    ASSERT_EQ(static_cast<int>(keys_h.extent(0)), N * N);
+    std::vector<int> curve(N * N);
+    std::iota(curve.begin(), curve.end(), 0);
+    std::sort(curve.begin(), curve.end(), [&](const int a, const int b) {
+      return keys_h(a) < keys_h(b);
+    });
+    // Both grids are filled by the curve of the 8 x 8 grid
+    const int n = 8;
+    for (int r = 0; r < N * N; ++r)
+    {
+      EXPECT_GE(keys_h(curve[r]), 0);
+      EXPECT_LT(keys_h(curve[r]), n * n);
+      if (r > 0) EXPECT_LT(keys_h(curve[r - 1]), keys_h(curve[r]));
+    }
+    if (N == 8)
+    {
+      for (int r = 1; r < N * N; ++r)
+      {
+        const int a = curve[r - 1];
+        const int b = curve[r];
+        EXPECT_EQ(std::abs(a / N - b / N) + std::abs(a % N - b % N), 1);
+      }
+    }
+
+    // The predictor finds the same points, in the order of the curve
+    MIRCO::ViewMatrix_h topology_h("topology_h", N, N);
+    for (int i = 0; i < N; ++i)
+      for (int j = 0; j < N; ++j) topology_h(i, j) = (7 * i + 3 * j) % 5;
+    const auto topology_d =
+        Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), topology_h);
+    const MIRCO::ViewVector_d meshgrid_d = MIRCO::CreateMeshgrid(N, 1.0);
+    MIRCO::ViewVectorGridIndex_d activeSet0_d, activeSet0curve_d;
+    MIRCO::ViewVector_d xv0_d, yv0_d, b0_d, xv0curve_d, yv0curve_d, b0curve_d;
+    MIRCO::ContactSetPredictor(activeSet0_d, xv0_d, yv0_d, b0_d, 4.0, 2.5, 0.0, topology_d,
+        meshgrid_d);
+    MIRCO::ContactSetPredictor(activeSet0curve_d, xv0curve_d, yv0curve_d, b0curve_d, 4.0, 2.5,
+        0.0, topology_d, meshgrid_d, true);
+
+    const auto activeSet0_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSet0_d);
+    const auto activeSet0curve_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSet0curve_d);
+    const auto b0curve_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), b0curve_d);
+    const auto xv0curve_h =
+        Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), xv0curve_d);
+    ASSERT_EQ(activeSet0curve_h.extent(0), activeSet0_h.extent(0));
+    EXPECT_GT(activeSet0_h.extent(0), 0);
+
+    std::vector<bool> predicted(N * N, false);
+    for (std::size_t k = 0; k < activeSet0_h.extent(0); ++k) predicted[activeSet0_h(k)] = true;
+    for (std::size_t k = 0; k < activeSet0curve_h.extent(0); ++k)
+    {
+      const int a = activeSet0curve_h(k);
+      EXPECT_TRUE(predicted[a]);
+      EXPECT_EQ(b0curve_h(k), topology_h(a / N, a % N) - 1.5);
+      EXPECT_EQ(xv0curve_h(k), xv0curve_h(0) + (a / N - activeSet0curve_h(0) / N));
+      if (k > 0) EXPECT_LT(keys_h(activeSet0curve_h(k - 1)), keys_h(a));
+    }
+  }
+}
+
+TEST(contactpredictor, estimate)
+{
+  // Paraboloid with the interference 0.5 at its summit, whose estimate is the Hertzian contact set
+  const int N = 21;
+  const double GridSize = 0.25;
+  const MIRCO::ViewVector_d meshgrid_d = MIRCO::CreateMeshgrid(N, GridSize);
+  const auto meshgrid_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), meshgrid_d);
+  MIRCO::ViewMatrix_h topology_h("topology_h", N, N);
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j)
+    {
+      const double x = meshgrid_h(i) - meshgrid_h(N / 2);
+      const double y = meshgrid_h(j) - meshgrid_h(N / 2);
+      topology_h(i, j) = -(x * x + y * y) / 4;
+    }
+  const auto topology_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), topology_h);
+  MIRCO::ViewVectorGridIndex_d activeSet0_d;
+  MIRCO::ViewVector_d xv0_d, yv0_d, b0_d;
+  MIRCO::ContactSetPredictor(
+      activeSet0_d, xv0_d, yv0_d, b0_d, 0.0, 0.5, 0.0, topology_d, meshgrid_d);
+  const int n0 = activeSet0_d.extent(0);
+
+  const MIRCO::ViewVectorInt_d estimate_d =
+      MIRCO::EstimateContactSet(activeSet0_d, b0_d, topology_d);
+  const auto estimate_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), estimate_d);
+  const auto b0_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), b0_d);
+  int expectedSize = 0;
+  for (int k = 0; k < n0; ++k)
+    if (b0_h(k) >= 0.25) ++expectedSize;
+  ASSERT_EQ(estimate_h.extent(0), expectedSize);
+  EXPECT_LT(expectedSize, n0);
+  for (int s = 0; s < expectedSize; ++s)
+  {
+    EXPECT_GE(b0_h(estimate_h(s)), 0.25);
+    if (s > 0) EXPECT_LT(estimate_h(s - 1), estimate_h(s));
+  }
+
+  // Solution for all predicted points
+  const MIRCO::PressureGreenFunction greenFunction(GridSize, 1.0);
+  MIRCO::ViewVector_d p0_d("p0_d", n0), pf_d;
+  MIRCO::ViewVectorGridIndex_d activeSetf_d;
+  MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d,
+      MIRCO::SetupMatrix(xv0_d, yv0_d, greenFunction, n0), b0_d);
+  const auto sum = [](const MIRCO::ViewVector_d v_d) {
+    const auto v_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), v_d);
+    double result = 0.0;
+    for (std::size_t i = 0; i < v_h.extent(0); ++i) result += v_h(i);
+    return result;
+  };
+  const double totalForce = sum(pf_d);
+
+  // The fallback extends the estimate, or even only the summit, until the solution for it is the
+  // solution for all predicted points
+  const MIRCO::OnTheFlyMatrix<MIRCO::PressureGreenFunction> matrix(xv0_d, yv0_d, greenFunction);
+  MIRCO::ViewVectorInt_d summit_d("summit_d", 1);
+  Kokkos::deep_copy(summit_d, estimate_h(expectedSize / 2));
+  for (MIRCO::ViewVectorInt_d subset_d : {estimate_d, summit_d})
+  {
+    const bool onlySummit = subset_d.extent(0) == 1;
+    int extensions = 0;
+    int added;
+    MIRCO::ViewVector_d pfSubset_d;
+    MIRCO::ViewVectorGridIndex_d activeSetfSubset_d;
+    MIRCO::NonlinearSolverState state;
+    MIRCO::ViewVector_d p_d("p_d", subset_d.extent(0));
+    do
+    {
+      MIRCO::ViewVectorGridIndex_d activeSet_d;
+      MIRCO::ViewVector_d xv_d, yv_d, b_d;
+      MIRCO::RestrictContactSet(
+          activeSet_d, xv_d, yv_d, b_d, subset_d, activeSet0_d, xv0_d, yv0_d, b0_d);
+      const int n = activeSet_d.extent(0);
+      ASSERT_EQ(p_d.extent(0), n);
+      const int iterations = MIRCO::nonlinearSolve(pfSubset_d, activeSetfSubset_d, p_d,
+          activeSet_d, MIRCO::SetupMatrix(xv_d, yv_d, greenFunction, n), b_d, false, &state);
+      // The initial guess of an extended estimate adds all of its added points at once
+      if (extensions > 0 && !onlySummit) EXPECT_LE(iterations, 2);
+      added = MIRCO::ExtendContactSetEstimate(subset_d, p_d, matrix, b0_d);
+      if (added > 0) ++extensions;
+    } while (added > 0 && extensions < n0);
+
+    EXPECT_LE(subset_d.extent(0), n0);
+    if (onlySummit) EXPECT_GT(extensions, 0);
+    ASSERT_EQ(activeSetfSubset_d.extent(0), activeSetf_d.extent(0));
+    EXPECT_NEAR(sum(pfSubset_d), totalForce, 1e-10 * totalForce);
+  }
+}
+
+// Count the grid indices of a range which decode to a point (i, j) of the grid
+struct GridIndexTest_decode
+{
+  int N_;
+  explicit GridIndexTest_decode(const int N) : N_(N) {}
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const MIRCO::GridIndex_t a, int& count) const
+  {
+    const int i = a / N_;
+    const int j = a % N_;
+    if (i >= 0 && i < N_ && MIRCO::GridIndex(i, j, N_) == a) ++count;
+  }
+};
+TEST(gridindex, beyond32bit)
+{
+  // A 65536 x 65536 grid has 2^32 points, i.e. its grid indices exceed the range of int
+  constexpr int N = 65536;
+  constexpr MIRCO::GridIndex_t int32Max = std::numeric_limits<int>::max();
+  EXPECT_EQ(MIRCO::GridIndex(N / 2, 0, N), int32Max + 1);
+  EXPECT_EQ(MIRCO::GridIndex(N - 1, N - 1, N), static_cast<MIRCO::GridIndex_t>(N) * N - 1);
+
+  // Loops over the grid points cover indices beyond 2^31 (checked around 2^31 and at the end of
+  // the grid without allocating fields of the grid)
+  for (const MIRCO::GridIndex_t begin :
+      {int32Max - 1000, static_cast<MIRCO::GridIndex_t>(N) * N - 1000})
+  {
+    int count = 0;
+    Kokkos::parallel_reduce(
+        MIRCO::GridRangePolicy_t(begin, begin + 1000), GridIndexTest_decode(N), count);
+    EXPECT_EQ(count, 1000);
+  }
+}
+
+// Look the positions of grid indices up in a GridIndexMap
+struct GridIndexTest_map
+{
+  MIRCO::GridIndexMap map_;
+  MIRCO::ViewVectorGridIndex_d queries_;
+  MIRCO::ViewVectorInt_d positions_;
+  KOKKOS_INLINE_FUNCTION
+  void operator()(const int k) const { positions_(k) = map_(queries_(k)); }
+};
+TEST(gridindex, map)
+{
+  // Unsorted grid indices of a 65536 x 65536 grid around and beyond 2^31, and indices which are
+  // not in the set
+  constexpr MIRCO::GridIndex_t int32Max = std::numeric_limits<int>::max();
+  const std::vector<MIRCO::GridIndex_t> set = {
+      int32Max + 5, 3, int32Max, (MIRCO::GridIndex_t(1) << 32) - 1, int32Max + 1, 0};
+  const std::vector<MIRCO::GridIndex_t> others = {1, int32Max - 1, int32Max + 2, int32Max + 6};
+  MIRCO::ViewVectorGridIndex_h set_h("set_h", set.size());
+  MIRCO::ViewVectorGridIndex_h queries_h("queries_h", set.size() + others.size());
+  for (std::size_t k = 0; k < set.size(); ++k) set_h(k) = queries_h(k) = set[k];
+  for (std::size_t k = 0; k < others.size(); ++k) queries_h(set.size() + k) = others[k];
+
+  const GridIndexTest_map lookup{
+      MIRCO::GridIndexMap(
+          Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), set_h)),
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), queries_h),
+      MIRCO::ViewVectorInt_d("positions", queries_h.extent(0))};
+  Kokkos::parallel_for(queries_h.extent(0), lookup);
+  const auto positions_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), lookup.positions_);
+  for (std::size_t k = 0; k < set.size(); ++k) EXPECT_EQ(positions_h(k), k);
+  for (std::size_t k = 0; k < others.size(); ++k) EXPECT_EQ(positions_h(set.size() + k), -1);
+}
+
+TEST(gridindex, strip)
+{
+  // Points of a strip of 3 x 12 points at the end of the middle rows of a 65536 x 65536 grid, whose
+  // grid indices exceed 2^31, which are indented by a paraboloid. The routines which address
+  // points by their grid indices only need memory for the points, not for the whole grid.
+  constexpr int N = 65536;
+  constexpr int rows = 3;
+  constexpr int columns = 12;
+  constexpr int n0 = rows * columns;
+  const double GridSize = 0.25;
+  MIRCO::ViewVectorGridIndex_h activeSet0_h("activeSet0_h", n0);
+  MIRCO::ViewVector_h xv0_h("xv0_h", n0), yv0_h("yv0_h", n0), b0_h("b0_h", n0);
+  MIRCO::ViewVector_h b0Shifted_h("b0Shifted_h", n0);
+  for (int k = 0; k < n0; ++k)
+  {
+    const int i = N / 2 + k / columns;
+    const int j = N - columns + k % columns;
+    activeSet0_h(k) = MIRCO::GridIndex(i, j, N);
+    xv0_h(k) = GridSize / 2 + i * GridSize;
+    yv0_h(k) = GridSize / 2 + j * GridSize;
+    const double dx = (k / columns - 1) * GridSize;
+    const double dy = (k % columns - 5.5) * GridSize;
+    b0_h(k) = 0.3 - (dx * dx + dy * dy) / 4;
+    b0Shifted_h(k) = b0_h(k) + 1e-3;
+  }
+  EXPECT_GT(activeSet0_h(0), std::numeric_limits<int>::max());
+  const auto toDevice = [](const auto view_h) {
+    return Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), view_h);
+  };
+  const auto activeSet0_d = toDevice(activeSet0_h);
+  const auto xv0_d = toDevice(xv0_h);
+  const auto yv0_d = toDevice(yv0_h);
+  const auto b0_d = toDevice(b0_h);
+  const auto b0Shifted_d = toDevice(b0Shifted_h);
+  const MIRCO::PressureGreenFunction greenFunction(GridSize, 1.5);
+  const MIRCO::OnTheFlyMatrix<MIRCO::PressureGreenFunction> matrix(xv0_d, yv0_d, greenFunction);
+
+  // The matrix of the first two rows is reused for all rows
+  const int previousN0 = 2 * columns;
+  const auto previousActiveSet_d =
+      Kokkos::subview(activeSet0_d, std::make_pair(0, previousN0));
+  const MIRCO::ViewMatrix_d previousH_d = MIRCO::SetupMatrix(
+      Kokkos::subview(xv0_d, std::make_pair(0, previousN0)),
+      Kokkos::subview(yv0_d, std::make_pair(0, previousN0)), greenFunction, previousN0);
+  std::size_t reusedEntries = 0;
+  const MIRCO::ViewMatrix_d H_d = MIRCO::SetupMatrix(xv0_d, yv0_d, greenFunction, n0);
+  const auto H_h = Kokkos::create_mirror_view_and_copy(
+      MIRCO::MemorySpace_Host_t(), MIRCO::UpdateMatrix(previousH_d, previousActiveSet_d,
+                                       activeSet0_d, xv0_d, yv0_d, greenFunction, reusedEntries));
+  EXPECT_EQ(reusedEntries, previousN0 * previousN0);
+  const auto expectedH_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), H_d);
+  for (int i = 0; i < n0; ++i)
+    for (int j = 0; j < n0; ++j) EXPECT_EQ(H_h(i, j), expectedH_h(i, j));
+
+  // Only some of the points are in contact
+  MIRCO::NonlinearSolverState state;
+  MIRCO::ViewVector_d p0_d("p0_d", n0);
+  MIRCO::ViewVector_d pf_d;
+  MIRCO::ViewVectorGridIndex_d activeSetf_d;
+  MIRCO::nonlinearSolve(pf_d, activeSetf_d, p0_d, activeSet0_d, matrix, b0_d, false, &state);
+  ASSERT_GT(activeSetf_d.extent(0), 1);
+  ASSERT_LT(activeSetf_d.extent(0), n0);
+
+  // The warm start finds the contact forces by their grid indices
+  const auto pf_h = Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pf_d);
+  const auto activeSetf_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetf_d);
+  const auto warmstart_h = Kokkos::create_mirror_view_and_copy(
+      MIRCO::MemorySpace_Host_t(), MIRCO::Warmstart(activeSet0_d, activeSetf_d, pf_d));
+  std::vector<double> p(n0, 0.0);
+  for (std::size_t i = 0; i < pf_h.extent(0); ++i)
+    for (int k = 0; k < n0; ++k)
+      if (activeSet0_h(k) == activeSetf_h(i)) p[k] = pf_h(i);
+  for (int k = 0; k < n0; ++k) EXPECT_EQ(warmstart_h(k), p[k]);
+
+  // A small shift of the indentation keeps the active set, and its closed form is the solution
+  MIRCO::ViewVector_d z_d;
+  ASSERT_TRUE(MIRCO::UniformIndentationResponse(z_d, state, greenFunction(0.0, 0.0)));
+  MIRCO::ViewVector_d pfShifted_d = pf_d;
+  ASSERT_TRUE(MIRCO::ShiftActiveSetSolution(
+      pfShifted_d, activeSetf_d, z_d, 1e-3, activeSet0_d, matrix, b0Shifted_d));
+  MIRCO::ViewVector_d p0Shifted_d("p0Shifted_d", n0);
+  MIRCO::ViewVector_d pfSolved_d;
+  MIRCO::ViewVectorGridIndex_d activeSetfSolved_d;
+  MIRCO::nonlinearSolve(pfSolved_d, activeSetfSolved_d, p0Shifted_d, activeSet0_d, matrix,
+      b0Shifted_d);
+  const auto pfShifted_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfShifted_d);
+  const auto pfSolved_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), pfSolved_d);
+  const auto activeSetfSolved_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSetfSolved_d);
+  ASSERT_EQ(pfSolved_h.extent(0), pfShifted_h.extent(0));
+  std::vector<double> pShifted(n0, 0.0), pSolved(n0, 0.0);
+  for (std::size_t i = 0; i < pfSolved_h.extent(0); ++i)
+    for (int k = 0; k < n0; ++k)
+    {
+      if (activeSet0_h(k) == activeSetf_h(i)) pShifted[k] = pfShifted_h(i);
+      if (activeSet0_h(k) == activeSetfSolved_h(i)) pSolved[k] = pfSolved_h(i);
+    }
+  for (int k = 0; k < n0; ++k) EXPECT_NEAR(pShifted[k], pSolved[k], 1e-10);
+}
+
+TEST(multilevel, hierarchy)
+{
+  MIRCO::ViewMatrix_h topology_h("topology_h", 9, 9);
+  for (int i = 0; i < 9; ++i)
+    for (int j = 0; j < 9; ++j) topology_h(i, j) = 10 * i + j;
+  MIRCO::ViewMatrix_d topology_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_Default_t(), topology_h);
+
+  // 9 -> 5 -> 3; a further level would have less than 3 points in one direction
+  std::vector<MIRCO::ViewMatrix_d> hierarchy = MIRCO::CreateTopologyHierarchy(topology_d, 5);
+
+  EXPECT_EQ(hierarchy.size(), 2);
+  EXPECT_EQ(hierarchy[0].extent(0), 5);
+  EXPECT_EQ(hierarchy[1].extent(0), 3);
+
+  MIRCO::ViewMatrix_h coarse_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::ExecSpace_DefaultHost_t(), hierarchy[1]);
+  EXPECT_EQ(coarse_h(1, 2), topology_h(4, 8));
+  EXPECT_EQ(coarse_h(2, 1), topology_h(8, 4));
+}
+
+TEST(multilevel, prolongation)
+{
+  // Coarse grid with N_c = 3, where the points (0, 0), (0, 1), (1, 0) and (1, 1) are in contact
+  MIRCO::ViewVectorGridIndex_h activeSet_c_h("activeSet_c_h", 4);
+  MIRCO::ViewVector_h p_c_h("p_c_h", 4);
+  activeSet_c_h(0) = 0;
+  activeSet_c_h(1) = 1;
+  activeSet_c_h(2) = 3;
+  activeSet_c_h(3) = 4;
+  p_c_h(0) = 1;
+  p_c_h(1) = 2;
+  p_c_h(2) = 3;
+  p_c_h(3) = 4;
+
+  MIRCO::ViewVectorGridIndex_d activeSet_c_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), activeSet_c_h);
+  MIRCO::ViewVector_d p_c_d =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_ofDefaultExec_t(), p_c_h);
+
+  MIRCO::ViewVectorGridIndex_d activeSet_f_d;
+  MIRCO::ViewVector_d p_f_d;
+  MIRCO::ProlongateContactSet(activeSet_f_d, p_f_d, activeSet_c_d, p_c_d, 3, 1.0);
+
+  MIRCO::ViewVectorGridIndex_h activeSet_f_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), activeSet_f_d);
+  MIRCO::ViewVector_h p_f_h =
+      Kokkos::create_mirror_view_and_copy(MIRCO::MemorySpace_Host_t(), p_f_d);
+
+  // Only the fine points (i, j) with 0 <= i, j <= 2 (on the fine grid with N_f = 5) are surrounded
+  // by coarse points in contact
+  EXPECT_EQ(activeSet_f_h.extent(0), 9);
+
+  // The order of the fine active set is not deterministic
+  std::map<int, double> p_f;
+  for (std::size_t i = 0; i < activeSet_f_h.extent(0); ++i) p_f[activeSet_f_h(i)] = p_f_h(i);
+
+  EXPECT_NEAR(p_f.at(0 * 5 + 0), 1.0, 1e-12);
+  EXPECT_NEAR(p_f.at(0 * 5 + 1), 1.5, 1e-12);
+  EXPECT_NEAR(p_f.at(1 * 5 + 1), 2.5, 1e-12);
+  EXPECT_NEAR(p_f.at(2 * 5 + 2), 4.0, 1e-12);
+  EXPECT_EQ(p_f.count(2 * 5 + 3), 0);
+}
+
+TEST(memory, estimate)
+{
+  const int N = 65;
+  const int n0 = 200;
+  const std::size_t n2 = static_cast<std::size_t>(n0) * n0;
+
+  const MIRCO::MemoryEstimate stored = MIRCO::EstimateSolverMemory(N, n0);
+  EXPECT_EQ(stored.Total(), [&] {
+    std::size_t total = 0;
+    for (const auto& part : stored.parts) total += part.second;
+    return total;
+  }());
+  const auto matrix = std::find_if(stored.parts.begin(), stored.parts.end(),
+      [](const auto& part) { return part.first == "Influence coefficient matrix H"; });
+  ASSERT_NE(matrix, stored.parts.end());
+  EXPECT_EQ(matrix->second, n2 * sizeof(double));
+
+  // Without the stored matrix, H_I (in the worst case of all predicted points) and the positions
+  // of the cached columns remain, and a hierarchical matrix needs no H_I either
+  const MIRCO::MemoryEstimate onTheFly = MIRCO::EstimateSolverMemory(N, n0, false);
+  EXPECT_EQ(stored.Total() - onTheFly.Total(), n2 * sizeof(double) - n0 * sizeof(int));
+  const MIRCO::MemoryEstimate hierarchical =
+      MIRCO::EstimateSolverMemory(N, n0, false, false, false, true);
+  EXPECT_EQ(stored.Total() - hierarchical.Total(), 2 * n2 * sizeof(double));
+
+  // H_I in single precision saves half of its memory, apart from the work vectors of the
+  // iterative refinement
+  const MIRCO::MemoryEstimate mixed = MIRCO::EstimateSolverMemory(N, n0, true, true);
+  EXPECT_EQ(stored.Total() - mixed.Total(),
+      n2 * (sizeof(double) - sizeof(float)) - n0 * (sizeof(double) + sizeof(float)));
+
+  // The influence kernel of all offsets replaces the coordinates of the predicted points
+  const MIRCO::MemoryEstimate lookup = MIRCO::EstimateSolverMemory(N, n0, true, false, true);
+  EXPECT_EQ(lookup.Total() - stored.Total(),
+      static_cast<std::size_t>(N) * N * sizeof(double) - 2 * n0 * sizeof(double));
+
+  // Exported fields and the FFT work arrays of the displacement field with M = 8 >= 2 N - 2
+  EXPECT_EQ(MIRCO::EstimateExportMemory(5).Total(), 25 * 57 + (25 * 8 + 64 * 24 + 8 * 8));
+}
+
+TEST(memory, budget)
+{
+  MIRCO::MemoryEstimate estimate;
+  estimate.parts.emplace_back("Part A", 1024);
+  estimate.parts.emplace_back("Part B", 512);
+  EXPECT_EQ(estimate.Total(), 1536);
+
+  EXPECT_NO_THROW(MIRCO::CheckMemoryBudget(estimate, 1536, "test"));
+  try
+  {
+    MIRCO::CheckMemoryBudget(estimate, 1000, "the test computation");
+    FAIL() << "Expected an exception";
+  }
+  catch (const std::runtime_error& e)
+  {
+    const std::string report = e.what();
+    EXPECT_NE(report.find("the test computation"), std::string::npos);
+    EXPECT_NE(report.find("Part A:"), std::string::npos);
+    EXPECT_NE(report.find("1.00 KiB"), std::string::npos);
+    EXPECT_NE(report.find("1.50 KiB"), std::string::npos);
+    EXPECT_NE(report.find("1000 B"), std::string::npos);
+  }
+}
+
+TEST(memory, formatbytes)
+{
+  EXPECT_EQ(MIRCO::FormatBytes(0), "0 B");
+  EXPECT_EQ(MIRCO::FormatBytes(1023), "1023 B");
+  EXPECT_EQ(MIRCO::FormatBytes(1536), "1.50 KiB");
+  EXPECT_EQ(MIRCO::FormatBytes(std::size_t(5) << 20), "5.00 MiB");
+  EXPECT_EQ(MIRCO::FormatBytes(std::size_t(3) << 30), "3.00 GiB");
+  EXPECT_EQ(MIRCO::FormatBytes(std::size_t(2048) << 40), "2048.00 TiB");
+}
+
+TEST(memory, peakresidentsetsize)
+{
+#if defined(__linux__) || defined(__APPLE__)
+  // The high-water mark includes an array which is resident at the same time
+  std::vector<char> block(std::size_t(32) << 20, 1);
+  EXPECT_GE(MIRCO::GetPeakResidentSetSize(), block.size());
+  EXPECT_EQ(block.back(), 1);
+#else
+  GTEST_SKIP() << "The peak resident set size is not available on this platform";
+#endif
+}
+
+TEST(timer, hierarchy)
+{
+  MIRCO::Timings timings;
+  EXPECT_EQ(timings.Push("evaluate"), "evaluate");
+  EXPECT_EQ(timings.Push("nnls"), "evaluate/nnls");
+  timings.Add("evaluate/nnls", 1.0);
+  timings.Pop();
+  EXPECT_EQ(timings.Push("nnls"), "evaluate/nnls");
+  timings.Add("evaluate/nnls", 2.0);
+  timings.Pop();
+  timings.Pop();
+  timings.Add("evaluate", 4.0);
+  EXPECT_EQ(timings.Push("export"), "export");
+  timings.Pop();
+  timings.Add("export", 1.0);
+
+  EXPECT_DOUBLE_EQ(timings.Get("evaluate"), 4.0);
+  EXPECT_DOUBLE_EQ(timings.Get("evaluate/nnls"), 3.0);
+  EXPECT_DOUBLE_EQ(timings.Get("missing"), 0.0);
+  EXPECT_EQ(timings.Phases().size(), 3);
+
+  // Nested phases are printed indented after their enclosing phase, with their share of it and
+  // the number of times they were timed
+  std::ostringstream out;
+  timings.Print(out);
+  std::istringstream lines(out.str());
+  std::vector<std::string> rows;
+  for (std::string line; std::getline(lines, line);)
+    if (!line.empty()) rows.push_back(line);
+
+  ASSERT_EQ(rows.size(), 5);
+  EXPECT_EQ(rows[2].rfind("evaluate ", 0), 0);
+  EXPECT_NE(rows[2].find("80.0 %"), std::string::npos);
+  EXPECT_EQ(rows[2].substr(rows[2].size() - 2), " 1");
+  EXPECT_EQ(rows[3].rfind("  nnls ", 0), 0);
+  EXPECT_NE(rows[3].find("75.0 %"), std::string::npos);
+  EXPECT_EQ(rows[3].substr(rows[3].size() - 2), " 2");
+  EXPECT_EQ(rows[4].rfind("export ", 0), 0);
+  EXPECT_NE(rows[4].find("20.0 %"), std::string::npos);
+}
+
+#if (MIRCO_ENABLE_VISUALIZATIONEXPORT)
+TEST(exportvisualization, asyncwriter)
+{
+  const int N = 4;
+  MIRCO::ViewMatrix_d pressure_d("pressure_d", N, N);
+  Kokkos::deep_copy(pressure_d, 1.0);
+  MIRCO::ViewVectorGridIndex_d activeSet_d("activeSet_d", 2);
+  Kokkos::deep_copy(activeSet_d, 5);
+
+  const auto readFile = [](const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  };
+
+  {
+    MIRCO::AsyncVisualizationWriter writer(1, "asyncwriter");
+    writer.Submit("asyncwriter_0", 0.5, 0.25f, activeSet_d, {pressure_d}, {"Pressure"});
+    // The snapshot is taken before Submit() returns
+    Kokkos::deep_copy(pressure_d, 2.0);
+    writer.Submit("asyncwriter_1", 1.5, 0.25f, activeSet_d, {pressure_d}, {"Pressure"});
+    writer.Wait();
+
+    for (const std::string file : {"asyncwriter_0.vti", "asyncwriter_1.vti"})
+    {
+      const std::string content = readFile(file);
+      EXPECT_NE(content.find("ImageData"), std::string::npos);
+      EXPECT_NE(content.find("\"Pressure\""), std::string::npos);
+      EXPECT_NE(content.find("\"Active Set\""), std::string::npos);
+    }
+  }
+
+  // The collection references both files with their times
+  const std::string collection = readFile("asyncwriter.pvd");
+  EXPECT_NE(
+      collection.find("timestep=\"0.5\" group=\"\" part=\"0\" file=\"asyncwriter_0.vti\""),
+      std::string::npos);
+  EXPECT_NE(
+      collection.find("timestep=\"1.5\" group=\"\" part=\"0\" file=\"asyncwriter_1.vti\""),
+      std::string::npos);
+
+  for (const char* file : {"asyncwriter.pvd", "asyncwriter_0.vti", "asyncwriter_1.vti"})
+    std::remove(file);
+}
+#endif
+
 int main(int argc, char **argv)
 {
   Kokkos::initialize(argc, argv);